@@ -29,6 +29,7 @@
 #include <Stream.h>
 
 #include "easyubx_drv.h"
+#include "EasyUBXSchema.h"
 
 class EasyUBX {
     public:
@@ -38,7 +39,9 @@ class EasyUBX {
         void set_debug_stream(Stream * stream);
 
         bool begin();
+        bool begin(const struct eubx_init_options &options); // with options.nonblocking loop() brings the receiver up
         void loop();
+        TEasyUBXBringUpState getBringUpState() const;
 
         TEasyUBXChipsetVersion getChiptsetVersion() const;
         const char * getSoftwareVersion() const;
@@ -46,14 +49,29 @@ class EasyUBX {
         TEasyUBXFixMode getPositionFixingMode() const;
         uint16_t getMeasurementRate() const;
         uint16_t getNavigationRate() const;
+        uint16_t getMeasurementTimeReference() const;
 
         TEasyUBXError setDynamicPlatformModel(TEasyUBXDynamicPlatformModel dyn_model, TEasyUBXFixMode fix_mode = EUBXFixModeAuto2D3D);
+        TEasyUBXError setMeasurementRate(uint16_t measurement_rate_ms, uint16_t navigation_rate = 1);
+
+        void setMessageCallback(eubx_notify_message callback, void * usr_ptr);
+
+        TEasyUBXError sendFrame(const uint8_t * frame, uint16_t length);
+
+        // sends the precomputed poll frame of a message described in EasyUBXSchema.h
+        template <typename M>
+        TEasyUBXError poll()
+        {
+            return sendFrame(EasyUBXSchema::PollFrame<M>::data, EasyUBXSchema::PollFrame<M>::length);
+        }
 
     private:
         static uint16_t receive_buffer_cb(void * usr_ptr, uint8_t * buffer, uint16_t max_length);
         static void send_byte_cb(void * usr_ptr, uint8_t buffer);
         static void send_buffer_cb(void * usr_ptr, const uint8_t * buffer, uint16_t length);
         static void notify_cb(void * usr_ptr, TEasyUBXEvent event);
+        static void message_cb(void * usr_ptr, const struct eubx_message_view * view);
+        static uint32_t time_cb(void * usr_ptr);
 
         uint16_t receive_buffer(uint8_t * buffer, uint16_t max_length);
         void send_byte(uint8_t buffer);
@@ -66,4 +84,6 @@ class EasyUBX {
         struct eubx_handle m_eubx_handle;
         Stream & m_stream;
         Stream * m_debug_stream;
+        eubx_notify_message m_message_callback;
+        void * m_message_usr_ptr;
 };
@@ -0,0 +1,261 @@
+/*
+ * Compile time message schema for the Easy UBX Arduino library
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef EASYUBX_SCHEMA_H
+#define EASYUBX_SCHEMA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "easyubx_drv.h"
+#include "easyubx_drv_consts.h"
+
+/*
+ * Message layouts are described by types: a message knows its class, id and payload
+ * length, a field its type, wire representation and offset. Encoders and decoders are
+ * generated from these descriptors, out of range fields fail to compile. Constant frames
+ * like polls are assembled including their checksum by the compiler and end up in rodata.
+ */
+namespace EasyUBXSchema
+{
+    namespace detail
+    {
+        template <size_t Size>
+        struct Unsigned;
+
+        template <>
+        struct Unsigned<1>
+        {
+            typedef uint8_t type;
+        };
+
+        template <>
+        struct Unsigned<2>
+        {
+            typedef uint16_t type;
+        };
+
+        template <>
+        struct Unsigned<4>
+        {
+            typedef uint32_t type;
+        };
+
+        // Fletcher-8 over the frame without sync bytes, returns ck_a in the low and ck_b in the high byte
+        constexpr uint16_t checksum(uint8_t ck_a, uint8_t ck_b)
+        {
+            return static_cast<uint16_t>(ck_a | (ck_b << 8));
+        }
+
+        template <typename... Bytes>
+        constexpr uint16_t checksum(uint8_t ck_a, uint8_t ck_b, uint8_t byte, Bytes... bytes)
+        {
+            return checksum(static_cast<uint8_t>(ck_a + byte), static_cast<uint8_t>(ck_b + ck_a + byte), bytes...);
+        }
+    } // namespace detail
+
+    // T is the type seen by the application, Repr the little endian integer on the wire
+    template <typename T, uint16_t Offset, typename Repr = T>
+    struct Field
+    {
+        typedef T type;
+        static constexpr uint16_t offset = Offset;
+        static constexpr uint16_t size = sizeof(Repr);
+        static constexpr uint16_t end = Offset + sizeof(Repr);
+
+        static T read(const uint8_t *payload)
+        {
+            typename detail::Unsigned<sizeof(Repr)>::type value = 0;
+
+            for (uint16_t i = sizeof(Repr); i > 0; i--)
+            {
+                value = (value << 8) | payload[Offset + i - 1];
+            }
+
+            return static_cast<T>(static_cast<Repr>(value));
+        }
+
+        static void write(uint8_t *payload, T value)
+        {
+            typename detail::Unsigned<sizeof(Repr)>::type raw = static_cast<Repr>(value);
+
+            for (uint16_t i = 0; i < sizeof(Repr); i++)
+            {
+                payload[Offset + i] = static_cast<uint8_t>(raw >> (8 * i));
+            }
+        }
+    };
+
+    template <uint8_t Class, uint8_t Id, uint16_t Length>
+    struct Message
+    {
+        static constexpr uint8_t message_class = Class;
+        static constexpr uint8_t message_id = Id;
+        static constexpr uint16_t length = Length;
+    };
+
+    // a frame known at compile time, e.g. a poll or a fixed configuration command
+    template <uint8_t Class, uint8_t Id, uint8_t... Payload>
+    struct ConstFrame
+    {
+        static constexpr uint16_t payload_length = sizeof...(Payload);
+        static constexpr uint16_t checksum = detail::checksum(0, 0, Class, Id, payload_length % 256, payload_length / 256, Payload...);
+        static constexpr uint16_t length = payload_length + EUBX_FRAME_OVERHEAD;
+        static constexpr uint8_t data[length] = {EUBX_SYNC1, EUBX_SYNC2, Class, Id, payload_length % 256, payload_length / 256, Payload..., checksum % 256, checksum / 256};
+    };
+
+    template <uint8_t Class, uint8_t Id, uint8_t... Payload>
+    constexpr uint8_t ConstFrame<Class, Id, Payload...>::data[];
+
+    template <typename M>
+    struct PollFrame : ConstFrame<M::message_class, M::message_id>
+    {
+    };
+
+    template <typename M>
+    class Encoder
+    {
+    public:
+        // prepares the send message of the handle, the payload starts zeroed
+        explicit Encoder(struct eubx_message &message) : m_message(message)
+        {
+            m_message.message_class = M::message_class;
+            m_message.message_id = M::message_id;
+            m_message.message_length = M::length;
+
+            for (uint16_t i = 0; (i < M::length) && (i < m_message.message_buffer_size); i++)
+            {
+                m_message.message_buffer[i] = 0;
+            }
+        }
+
+        bool fits() const
+        {
+            return M::length <= m_message.message_buffer_size;
+        }
+
+        template <typename F>
+        Encoder &set(typename F::type value)
+        {
+            static_assert(F::end <= M::length, "field outside of the message payload");
+
+            if (fits())
+            {
+                F::write(m_message.message_buffer, value);
+            }
+
+            return *this;
+        }
+
+    private:
+        struct eubx_message &m_message;
+    };
+
+    template <typename M>
+    class Decoder
+    {
+    public:
+        Decoder(const uint8_t *payload, uint16_t length) : m_payload(payload), m_length(length)
+        {
+        }
+
+        explicit Decoder(const struct eubx_message_view &view) : m_payload(view.payload), m_length(view.message_length)
+        {
+        }
+
+        static bool matches(const struct eubx_message_view &view)
+        {
+            return (M::message_class == view.message_class) && (M::message_id == view.message_id);
+        }
+
+        // longer payloads are accepted, receivers append fields in newer protocol versions
+        bool valid() const
+        {
+            return M::length <= m_length;
+        }
+
+        template <typename F>
+        typename F::type get() const
+        {
+            static_assert(F::end <= M::length, "field outside of the message payload");
+
+            return F::read(m_payload);
+        }
+
+    private:
+        const uint8_t *m_payload;
+        uint16_t m_length;
+    };
+
+    struct CfgNav5 : Message<EUBX_CLASS_CFG, EUBX_ID_CFG_NAV5, 36>
+    {
+        typedef Field<uint16_t, 0> Mask;
+        typedef Field<TEasyUBXDynamicPlatformModel, 2, uint8_t> DynModel;
+        typedef Field<TEasyUBXFixMode, 3, uint8_t> FixMode;
+    };
+
+    struct CfgRate : Message<EUBX_CLASS_CFG, EUBX_ID_CFG_RATE, 6>
+    {
+        typedef Field<uint16_t, 0> MeasurementRate;
+        typedef Field<uint16_t, 2> NavigationRate;
+        typedef Field<uint16_t, 4> TimeReference;
+    };
+
+    struct MonVer : Message<EUBX_CLASS_MON, EUBX_ID_MON_VER, 40>
+    {
+    };
+
+    struct NavPosllh : Message<EUBX_CLASS_NAV, EUBX_ID_NAV_POSLLH, 28>
+    {
+        typedef Field<uint32_t, 0> ITow;
+        typedef Field<int32_t, 4> Longitude;
+        typedef Field<int32_t, 8> Latitude;
+        typedef Field<int32_t, 12> Height;
+        typedef Field<int32_t, 16> HeightMsl;
+        typedef Field<uint32_t, 20> HorizontalAccuracy;
+        typedef Field<uint32_t, 24> VerticalAccuracy;
+    };
+
+    struct NavPvt : Message<EUBX_CLASS_NAV, EUBX_ID_NAV_PVT, 84>
+    {
+        typedef Field<uint32_t, 0> ITow;
+        typedef Field<uint8_t, 20> FixType;
+        typedef Field<uint8_t, 21> Flags;
+        typedef Field<uint8_t, 23> NumSv;
+        typedef Field<int32_t, 24> Longitude;
+        typedef Field<int32_t, 28> Latitude;
+        typedef Field<int32_t, 36> HeightMsl;
+        typedef Field<uint32_t, 40> HorizontalAccuracy;
+        typedef Field<int32_t, 60> GroundSpeed;
+        typedef Field<int32_t, 64> HeadingMotion;
+    };
+
+    static_assert(PollFrame<MonVer>::checksum == 0x340e, "MON-VER poll checksum");
+} // namespace EasyUBXSchema
+
+#endif /* EASYUBX_SCHEMA_H */
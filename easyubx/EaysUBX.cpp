@@ -26,12 +26,16 @@
   SOFTWARE.
 */
 
+#include <Arduino.h>
+
 #include "EasyUBX.h"
 
 EasyUBX::EasyUBX(Stream &stream) : m_stream(stream)
 {
     m_debug_stream = nullptr;
     m_initialized = false;
+    m_message_callback = nullptr;
+    m_message_usr_ptr = nullptr;
 }
 
 EasyUBX::~EasyUBX()
@@ -40,7 +44,19 @@ EasyUBX::~EasyUBX()
 
 bool EasyUBX::begin()
 {
-    if (EUBX_ERROR_OK == eubx_init(&m_eubx_handle, receive_buffer_cb, send_byte_cb, send_buffer_cb, notify_cb, this))
+    struct eubx_init_options options = {};
+
+    return begin(options);
+}
+
+bool EasyUBX::begin(const struct eubx_init_options &options)
+{
+    struct eubx_init_options wrapper_options = options;
+
+    wrapper_options.notify_message = message_cb;
+    wrapper_options.get_time = time_cb;
+
+    if (EUBX_ERROR_OK == eubx_init_ex(&m_eubx_handle, receive_buffer_cb, send_byte_cb, send_buffer_cb, notify_cb, this, &wrapper_options))
     {
         m_initialized = true;
     }
@@ -61,6 +77,11 @@ void EasyUBX::loop()
     }
 }
 
+TEasyUBXBringUpState EasyUBX::getBringUpState() const
+{
+    return eubx_bringup_state(&m_eubx_handle);
+}
+
 TEasyUBXChipsetVersion EasyUBX::getChiptsetVersion() const
 {
     return m_eubx_handle.receiver_info.chipset_version;
@@ -96,9 +117,38 @@ uint16_t EasyUBX::getMeasurementTimeReference() const
     return m_eubx_handle.receiver_config.rate_time_reference;
 }
 
+TEasyUBXError EasyUBX::setMeasurementRate(uint16_t measurement_rate_ms, uint16_t navigation_rate)
+{
+    return eubx_set_measurement_rate(&m_eubx_handle, measurement_rate_ms, navigation_rate, m_eubx_handle.receiver_config.rate_time_reference);
+}
+
 TEasyUBXError EasyUBX::setDynamicPlatformModel(TEasyUBXDynamicPlatformModel dyn_model, TEasyUBXFixMode fix_mode)
 {
-    return eubx_set_dyn_model(&m_eubx_handle, dyn_model, fix_mode);
+    typedef EasyUBXSchema::CfgNav5 CfgNav5;
+
+    TEasyUBXError rc = EUBX_ERROR_SEND_OVERFLOW;
+    EasyUBXSchema::Encoder<CfgNav5> encoder(m_eubx_handle.send_message);
+
+    if (encoder.fits())
+    {
+        // only the dynamic model and fix mode are applied
+        encoder.set<CfgNav5::Mask>(0x0005).set<CfgNav5::DynModel>(dyn_model).set<CfgNav5::FixMode>(fix_mode);
+
+        rc = eubx_send_message_wait4ack(&m_eubx_handle, CfgNav5::message_class, CfgNav5::message_id);
+    }
+
+    return rc;
+}
+
+TEasyUBXError EasyUBX::sendFrame(const uint8_t *frame, uint16_t length)
+{
+    return eubx_send_frame(&m_eubx_handle, frame, length);
+}
+
+void EasyUBX::setMessageCallback(eubx_notify_message callback, void *usr_ptr)
+{
+    m_message_callback = callback;
+    m_message_usr_ptr = usr_ptr;
 }
 
 uint16_t EasyUBX::receive_buffer_cb(void *usr_ptr, uint8_t *buffer, uint16_t max_length)
@@ -121,6 +171,21 @@ void EasyUBX::notify_cb(void *usr_ptr, TEasyUBXEvent event)
     static_cast<EasyUBX *>(usr_ptr)->notify(event);
 }
 
+void EasyUBX::message_cb(void *usr_ptr, const struct eubx_message_view *view)
+{
+    EasyUBX *self = static_cast<EasyUBX *>(usr_ptr);
+
+    if (nullptr != self->m_message_callback)
+    {
+        self->m_message_callback(self->m_message_usr_ptr, view);
+    }
+}
+
+uint32_t EasyUBX::time_cb(void *usr_ptr)
+{
+    return micros();
+}
+
 uint16_t EasyUBX::receive_buffer(uint8_t *buffer, uint16_t max_length)
 {
     uint16_t received = 0;
@@ -0,0 +1,767 @@
+/*
+ * Parser, dispatch and decoder benchmarks on synthetic UBX streams
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#if defined(__linux__)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "easyubx_drv.h"
+#include "easyubx_drv_consts.h"
+#include "easyubx_drv_nav.h"
+#include "easyubx_host_capture.h"
+
+#define BENCH_DEFAULT_STREAM_SIZE (8 * 1024 * 1024)
+#define BENCH_DEFAULT_REPEAT 5
+#define BENCH_DEFAULT_CHUNK 256
+#define BENCH_DECODER_CALLS 1000000
+#define BENCH_DISPATCH_FRAMES 1000000
+#define BENCH_DISPATCH_HANDLERS 8
+#define BENCH_CAPTURE_RECORD 4096
+#define BENCH_RECEIVE_ARENA_SIZE 1024 // RTCM frames of the generator reach 225 bytes, more than the embedded buffer
+
+/*
+ * Every message kind of the synthetic stream with its weight in the mix. Payloads are
+ * pseudo random but the generator is seeded, so the same options always produce the
+ * same stream and runs can be compared with each other.
+ */
+enum bench_kind
+{
+    BenchNavPVT,
+    BenchNavPOSLLH,
+    BenchNavVELNED,
+    BenchNavSOL,
+    BenchNavDOP,
+    BenchNavTIMEUTC,
+    BenchNmea,
+    BenchRtcm,
+    BenchOther,
+    BenchKindCount
+};
+
+struct bench_kind_info
+{
+    const char *name;
+    uint8_t message_class;
+    uint8_t message_id;
+    uint16_t length;
+    unsigned weight;
+};
+
+static struct bench_kind_info kinds[BenchKindCount] = {
+    [BenchNavPVT] = {"pvt", EUBX_CLASS_NAV, EUBX_ID_NAV_PVT, 92, 4},
+    [BenchNavPOSLLH] = {"posllh", EUBX_CLASS_NAV, EUBX_ID_NAV_POSLLH, 28, 1},
+    [BenchNavVELNED] = {"velned", EUBX_CLASS_NAV, EUBX_ID_NAV_VELENED, 36, 1},
+    [BenchNavSOL] = {"sol", EUBX_CLASS_NAV, EUBX_ID_NAV_SOL, 52, 1},
+    [BenchNavDOP] = {"dop", EUBX_CLASS_NAV, EUBX_ID_NAV_DOP, 18, 1},
+    [BenchNavTIMEUTC] = {"timeutc", EUBX_CLASS_NAV, EUBX_ID_NAV_TIMEUTC, 20, 1},
+    [BenchNmea] = {"nmea", 0, 0, 0, 0},
+    [BenchRtcm] = {"rtcm", 0, 0, 0, 0},
+    [BenchOther] = {"other", EUBX_CLASS_RXM, 0x15, 64, 0}, // RXM-RAWX sized frame without a decoder
+};
+
+struct bench_stream
+{
+    uint8_t *data;
+    size_t length;
+    size_t capacity;
+    uint32_t seed;
+    unsigned error_permille; // share of messages damaged by the generator
+    uint32_t messages;
+    uint32_t ubx_frames; // intact UBX frames the parser must deliver
+    uint32_t nmea_sentences;
+    uint32_t rtcm_frames;
+    uint32_t corrupted; // one byte after the header flipped
+    uint32_t truncated; // tail of the frame missing
+    uint32_t garbage;   // random bytes in front of the message
+};
+
+struct bench_counters
+{
+    uint64_t frames;
+    uint64_t nmea;
+    uint64_t rtcm;
+    uint64_t events;
+};
+
+static struct bench_counters counters;
+static volatile uint32_t sink; // keeps checksum results alive
+static bool fast_resync;
+static const uint8_t *response_data;
+static size_t response_length;
+
+static uint32_t next_random(uint32_t *state)
+{
+    // xorshift32, never reaches zero from a non zero seed
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+
+    return *state;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static uint32_t host_time_us(void *usr_ptr)
+{
+    return (uint32_t)(now_ns() / 1000);
+}
+
+static uint8_t *stream_reserve(struct bench_stream *stream, size_t length)
+{
+    if (stream->length + length > stream->capacity)
+    {
+        stream->capacity = 2 * (stream->capacity + length);
+        stream->data = realloc(stream->data, stream->capacity);
+    }
+
+    return &stream->data[stream->length];
+}
+
+// random payload when none is given
+static size_t append_ubx(struct bench_stream *stream, uint8_t message_class, uint8_t message_id, const uint8_t *payload, uint16_t length)
+{
+    uint8_t *frame = stream_reserve(stream, length + EUBX_FRAME_OVERHEAD);
+    uint8_t ck_a = 0;
+    uint8_t ck_b = 0;
+
+    frame[0] = EUBX_SYNC1;
+    frame[1] = EUBX_SYNC2;
+    frame[2] = message_class;
+    frame[3] = message_id;
+    frame[4] = length & 0xff;
+    frame[5] = length >> 8;
+
+    for (uint16_t i = 0; i < length; i++)
+    {
+        frame[EUBX_FRAME_HEADER_LENGTH + i] = (NULL != payload) ? payload[i] : next_random(&stream->seed);
+    }
+
+    eubx_checksum_update(&ck_a, &ck_b, &frame[2], length + EUBX_FRAME_HEADER_LENGTH - 2);
+    frame[EUBX_FRAME_HEADER_LENGTH + length] = ck_a;
+    frame[EUBX_FRAME_HEADER_LENGTH + length + 1] = ck_b;
+    stream->length += length + EUBX_FRAME_OVERHEAD;
+
+    return length + EUBX_FRAME_OVERHEAD;
+}
+
+static size_t append_nmea(struct bench_stream *stream)
+{
+    char sentence[EUBX_NMEA_MAX_LENGTH];
+    uint8_t checksum = 0;
+    uint32_t value = next_random(&stream->seed);
+    int length = snprintf(sentence, sizeof(sentence), "$GNGGA,%06u.00,%04u.%05u,N,%05u.%05u,E,1,%02u,0.9,%u.%u,M,47.0,M,,",
+                          value % 240000, value % 9000, value % 100000, (value >> 8) % 18000, (value >> 4) % 100000, value % 13, value % 500, value % 10);
+
+    for (int i = 1; i < length; i++)
+    {
+        checksum ^= sentence[i];
+    }
+
+    length += snprintf(&sentence[length], sizeof(sentence) - length, "*%02X\r\n", checksum);
+    memcpy(stream_reserve(stream, length), sentence, length);
+    stream->length += length;
+
+    return length;
+}
+
+static size_t append_rtcm(struct bench_stream *stream)
+{
+    uint16_t length = 20 + next_random(&stream->seed) % 200;
+    uint8_t *frame = stream_reserve(stream, length + 6);
+    uint32_t crc;
+
+    frame[0] = EUBX_RTCM3_PREAMBLE;
+    frame[1] = (length >> 8) & 0x03;
+    frame[2] = length & 0xff;
+
+    for (uint16_t i = 0; i < length; i++)
+    {
+        frame[3 + i] = next_random(&stream->seed);
+    }
+
+    crc = eubx_crc24q_update(0, frame, length + 3);
+    frame[length + 3] = crc >> 16;
+    frame[length + 4] = crc >> 8;
+    frame[length + 5] = crc;
+    stream->length += length + 6;
+
+    return length + 6;
+}
+
+// damages the message that was just appended or puts noise in front of it, true if the message itself is still intact
+static bool inject_error(struct bench_stream *stream, size_t start, size_t length)
+{
+    uint32_t choice = next_random(&stream->seed);
+    bool intact = false;
+
+    switch (choice % 3)
+    {
+    case 0:
+        stream->data[start + 6 + (choice >> 8) % (length - 6)] ^= 0x5a;
+        stream->corrupted++;
+        break;
+
+    case 1:
+        stream->length -= 1 + (choice >> 8) % (length - 1);
+        stream->truncated++;
+        break;
+
+    default:
+    {
+        size_t noise = 1 + (choice >> 8) % 16;
+
+        stream_reserve(stream, noise);
+        memmove(&stream->data[start + noise], &stream->data[start], length);
+
+        for (size_t i = 0; i < noise; i++)
+        {
+            stream->data[start + i] = next_random(&stream->seed);
+        }
+
+        stream->length += noise;
+        stream->garbage++;
+        intact = true;
+        break;
+    }
+    }
+
+    return intact;
+}
+
+static void generate_stream(struct bench_stream *stream, size_t size)
+{
+    unsigned total_weight = 0;
+
+    for (int kind = 0; kind < BenchKindCount; kind++)
+    {
+        total_weight += kinds[kind].weight;
+    }
+
+    while (stream->length < size)
+    {
+        unsigned pick = next_random(&stream->seed) % total_weight;
+        int kind = 0;
+        size_t start = stream->length;
+        size_t length;
+        bool damaged = (next_random(&stream->seed) % 1000) < stream->error_permille;
+        bool intact = true;
+
+        while (pick >= kinds[kind].weight)
+        {
+            pick -= kinds[kind].weight;
+            kind++;
+        }
+
+        if (BenchNmea == kind)
+        {
+            length = append_nmea(stream);
+        }
+        else if (BenchRtcm == kind)
+        {
+            length = append_rtcm(stream);
+        }
+        else
+        {
+            length = append_ubx(stream, kinds[kind].message_class, kinds[kind].message_id, NULL, kinds[kind].length);
+        }
+
+        if (damaged)
+        {
+            intact = inject_error(stream, start, length);
+        }
+
+        // what a perfect parser delivers, noise in front of a message may still cost frames after it
+        if (intact)
+        {
+            stream->nmea_sentences += (BenchNmea == kind);
+            stream->rtcm_frames += (BenchRtcm == kind);
+            stream->ubx_frames += (BenchNmea != kind) && (BenchRtcm != kind);
+        }
+
+        stream->messages++;
+    }
+}
+
+static uint16_t bench_receive_buffer(void *usr_ptr, uint8_t *buffer, uint16_t max_length)
+{
+    uint16_t length = (response_length < max_length) ? response_length : max_length;
+
+    memcpy(buffer, response_data, length);
+    response_data += length;
+    response_length -= length;
+
+    return length;
+}
+
+static void bench_send_byte(void *usr_ptr, uint8_t byte)
+{
+}
+
+static void bench_send_buffer(void *usr_ptr, const uint8_t *buffer, uint16_t length)
+{
+}
+
+static void bench_notify_event(void *usr_ptr, TEasyUBXEvent event)
+{
+    counters.events++;
+}
+
+static void bench_notify_message(void *usr_ptr, const struct eubx_message_view *view)
+{
+    counters.frames++;
+}
+
+static void bench_notify_nmea(void *usr_ptr, const char *sentence, uint16_t length)
+{
+    counters.nmea++;
+}
+
+static void bench_notify_rtcm(void *usr_ptr, const uint8_t *frame, uint16_t length)
+{
+    counters.rtcm++;
+}
+
+static void bench_handler(void *usr_ptr, struct eubx_handle *pHandle, const struct eubx_message_view *view)
+{
+    counters.events++;
+}
+
+// init polls MON-VER, CFG-NAV5 and CFG-RATE, the answers are canned so no receiver is needed
+static TEasyUBXError init_handle(struct eubx_handle *pHandle)
+{
+    static struct bench_stream responses;
+    static uint8_t version[40];
+    static const uint8_t nav5[36] = {0xff, 0xff, 4, 3};
+    static const uint8_t cfg_rate[6] = {0xe8, 0x03, 0x01, 0x00, 0x01, 0x00};
+    static const uint8_t ack_nav5[2] = {EUBX_CLASS_CFG, EUBX_ID_CFG_NAV5};
+    static const uint8_t ack_rate[2] = {EUBX_CLASS_CFG, EUBX_ID_CFG_RATE};
+    static uint8_t receive_arena[BENCH_RECEIVE_ARENA_SIZE];
+    struct eubx_init_options options;
+
+    memcpy(version, "ROM CORE 3.01", 13);
+    memcpy(&version[30], "00080000", 8);
+    responses.length = 0;
+    append_ubx(&responses, EUBX_CLASS_MON, EUBX_ID_MON_VER, version, sizeof(version));
+    append_ubx(&responses, EUBX_CLASS_CFG, EUBX_ID_CFG_NAV5, nav5, sizeof(nav5));
+    append_ubx(&responses, EUBX_CLASS_ACK, EUBX_ID_ACK_ACK, ack_nav5, sizeof(ack_nav5));
+    append_ubx(&responses, EUBX_CLASS_CFG, EUBX_ID_CFG_RATE, cfg_rate, sizeof(cfg_rate));
+    append_ubx(&responses, EUBX_CLASS_ACK, EUBX_ID_ACK_ACK, ack_rate, sizeof(ack_rate));
+    response_data = responses.data;
+    response_length = responses.length;
+
+    memset(&options, 0, sizeof(options));
+    options.get_time = host_time_us;
+    options.notify_message = bench_notify_message;
+    options.notify_nmea = bench_notify_nmea;
+    options.notify_rtcm = bench_notify_rtcm;
+    options.fast_resync = fast_resync;
+    options.receive_arena = receive_arena;
+    options.receive_arena_size = sizeof(receive_arena);
+
+    return eubx_init_ex(pHandle, bench_receive_buffer, bench_send_byte, bench_send_buffer, bench_notify_event, NULL, &options);
+}
+
+static double best_seconds(uint64_t elapsed_ns, double best)
+{
+    double seconds = elapsed_ns / 1e9;
+
+    return ((0 == best) || (seconds < best)) ? seconds : best;
+}
+
+static double bench_checksum(const struct bench_stream *stream, int repeat)
+{
+    double best = 0;
+
+    for (int run = 0; run < repeat; run++)
+    {
+        uint8_t ck_a = 0;
+        uint8_t ck_b = 0;
+        uint64_t start = now_ns();
+
+        eubx_checksum_update(&ck_a, &ck_b, stream->data, stream->length);
+        best = best_seconds(now_ns() - start, best);
+        sink ^= ck_a ^ ck_b;
+    }
+
+    return best;
+}
+
+static double bench_crc24q(const struct bench_stream *stream, int repeat)
+{
+    double best = 0;
+
+    for (int run = 0; run < repeat; run++)
+    {
+        uint64_t start = now_ns();
+        uint32_t crc = eubx_crc24q_update(0, stream->data, stream->length);
+
+        best = best_seconds(now_ns() - start, best);
+        sink ^= crc;
+    }
+
+    return best;
+}
+
+// whole stream through eubx_receive_bytes in chunks, like a transport would hand it over
+static double bench_framer(struct eubx_handle *pHandle, const struct bench_stream *stream, size_t chunk, int repeat)
+{
+    double best = 0;
+
+    for (int run = 0; run < repeat; run++)
+    {
+        uint64_t start = now_ns();
+
+        memset(&counters, 0, sizeof(counters));
+
+        for (size_t offset = 0; offset < stream->length; offset += chunk)
+        {
+            size_t length = (stream->length - offset < chunk) ? stream->length - offset : chunk;
+
+            eubx_receive_bytes(pHandle, &stream->data[offset], length);
+        }
+
+        best = best_seconds(now_ns() - start, best);
+    }
+
+    return best;
+}
+
+// empty frames spread over several user handlers, so the cost is framing plus handler lookup
+static double bench_dispatch(struct eubx_handle *pHandle, int repeat)
+{
+    struct bench_stream frames;
+    double best = 0;
+
+    memset(&frames, 0, sizeof(frames));
+    frames.seed = 1;
+
+    for (uint8_t id = 0; id < BENCH_DISPATCH_HANDLERS; id++)
+    {
+        eubx_register_handler(pHandle, EUBX_CLASS_RXM, id, bench_handler, NULL);
+    }
+
+    for (uint32_t i = 0; i < BENCH_DISPATCH_FRAMES; i++)
+    {
+        append_ubx(&frames, EUBX_CLASS_RXM, i % BENCH_DISPATCH_HANDLERS, NULL, 0);
+    }
+
+    for (int run = 0; run < repeat; run++)
+    {
+        uint64_t start = now_ns();
+
+        eubx_receive_bytes(pHandle, frames.data, frames.length);
+        best = best_seconds(now_ns() - start, best);
+    }
+
+    free(frames.data);
+
+    return best;
+}
+
+// one built in decoder called on a payload already in the receive storage
+static double bench_decoder(struct eubx_handle *pHandle, enum bench_kind kind, int repeat)
+{
+    eubx_drv_handler handler = eubx_drv_nav_dispatch.handlers[kinds[kind].message_id];
+    uint32_t seed = 1;
+    double best = 0;
+
+    pHandle->receive_message.message_class = kinds[kind].message_class;
+    pHandle->receive_message.message_id = kinds[kind].message_id;
+    pHandle->receive_message.message_length = kinds[kind].length;
+
+    for (uint16_t i = 0; i < kinds[kind].length; i++)
+    {
+        pHandle->receive_message.message_buffer[i] = next_random(&seed);
+    }
+
+    for (int run = 0; run < repeat; run++)
+    {
+        uint64_t start = now_ns();
+
+        for (uint32_t call = 0; call < BENCH_DECODER_CALLS; call++)
+        {
+            handler(pHandle);
+        }
+
+        best = best_seconds(now_ns() - start, best);
+    }
+
+    return best;
+}
+
+// the stream written as a capture and replayed from the mapping at full speed
+static double bench_replay(struct eubx_handle *pHandle, const struct bench_stream *stream, int repeat)
+{
+    char path[] = "/tmp/easyubx_bench_XXXXXX";
+    struct eubx_capture_writer writer;
+    struct eubx_replay replay;
+    double best = 0;
+    int fd = mkstemp(path);
+
+    if ((0 <= fd) && (EUBX_ERROR_OK == eubx_capture_open(&writer, path)))
+    {
+        for (size_t offset = 0; offset < stream->length; offset += BENCH_CAPTURE_RECORD)
+        {
+            size_t length = (stream->length - offset < BENCH_CAPTURE_RECORD) ? stream->length - offset : BENCH_CAPTURE_RECORD;
+
+            eubx_capture_tap(&writer, EUBXDirectionRx, &stream->data[offset], length);
+        }
+
+        eubx_capture_close(&writer);
+
+        for (int run = 0; run < repeat; run++)
+        {
+            if (EUBX_ERROR_OK == eubx_replay_open(&replay, path, false))
+            {
+                uint64_t start = now_ns();
+
+                eubx_replay_run(&replay, pHandle);
+                best = best_seconds(now_ns() - start, best);
+                eubx_replay_close(&replay);
+            }
+        }
+    }
+
+    if (0 <= fd)
+    {
+        close(fd);
+        unlink(path);
+    }
+
+    return best;
+}
+
+static double per_second(double amount, double seconds)
+{
+    return (0 < seconds) ? amount / seconds : 0;
+}
+
+static bool parse_mix(const char *mix)
+{
+    char buffer[256];
+    bool valid = strlen(mix) < sizeof(buffer);
+    unsigned total_weight = 0;
+
+    if (valid)
+    {
+        strcpy(buffer, mix);
+
+        for (int kind = 0; kind < BenchKindCount; kind++)
+        {
+            kinds[kind].weight = 0;
+        }
+    }
+
+    for (char *item = valid ? strtok(buffer, ",") : NULL; valid && (NULL != item); item = strtok(NULL, ","))
+    {
+        char *weight = strchr(item, '=');
+        int kind = 0;
+
+        if (NULL != weight)
+        {
+            *weight++ = 0;
+        }
+
+        while ((kind < BenchKindCount) && (0 != strcmp(item, kinds[kind].name)))
+        {
+            kind++;
+        }
+
+        valid = (kind < BenchKindCount);
+
+        if (valid)
+        {
+            kinds[kind].weight = (NULL != weight) ? (unsigned)atoi(weight) : 1;
+        }
+    }
+
+    // an empty mix could never fill the stream
+    for (int kind = 0; valid && (kind < BenchKindCount); kind++)
+    {
+        total_weight += kinds[kind].weight;
+    }
+
+    return valid && (0 < total_weight);
+}
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "usage: %s [-s bytes] [-m kind=weight,...] [-e errors_per_mille] [-c chunk] [-r repeat] [-S seed] [-o file.json] [-R]\n", program);
+    fprintf(stderr, "kinds: pvt posllh velned sol dop timeutc nmea rtcm other\n");
+}
+
+int main(int argc, char **argv)
+{
+    struct bench_stream stream;
+    struct eubx_handle handle;
+    size_t size = BENCH_DEFAULT_STREAM_SIZE;
+    size_t chunk = BENCH_DEFAULT_CHUNK;
+    int repeat = BENCH_DEFAULT_REPEAT;
+    FILE *output = stdout;
+    uint32_t seed;
+    int option;
+    int status = 0;
+
+    memset(&stream, 0, sizeof(stream));
+    stream.seed = 0x75627862;
+
+    while (-1 != (option = getopt(argc, argv, "s:m:e:c:r:S:o:Rh")))
+    {
+        switch (option)
+        {
+        case 's':
+            size = strtoul(optarg, NULL, 0);
+            break;
+
+        case 'm':
+            if (!parse_mix(optarg))
+            {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+
+        case 'e':
+            stream.error_permille = atoi(optarg);
+            break;
+
+        case 'c':
+            chunk = strtoul(optarg, NULL, 0);
+            break;
+
+        case 'r':
+            repeat = atoi(optarg);
+            break;
+
+        case 'S':
+            stream.seed = strtoul(optarg, NULL, 0);
+            break;
+
+        case 'o':
+            output = fopen(optarg, "w");
+            break;
+
+        case 'R':
+            fast_resync = true;
+            break;
+
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if ((0 == size) || (0 == chunk) || (1 > repeat) || (1000 < stream.error_permille) || (0 == stream.seed) || (NULL == output))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (EUBX_ERROR_OK != init_handle(&handle))
+    {
+        fprintf(stderr, "init against the canned responses failed\n");
+        return 1;
+    }
+
+    seed = stream.seed;
+    generate_stream(&stream, size);
+
+    fprintf(output, "{\n  \"config\": {\"stream_bytes\": %zu, \"messages\": %u, \"chunk\": %zu, \"repeat\": %d, \"seed\": %u, \"error_permille\": %u, \"fast_resync\": %s, \"optimized\": %s,\n    \"mix\": {",
+            stream.length, stream.messages, chunk, repeat, seed, stream.error_permille, fast_resync ? "true" : "false",
+#if defined(__OPTIMIZE__)
+            "true"
+#else
+            "false"
+#endif
+    );
+
+    for (int kind = 0; kind < BenchKindCount; kind++)
+    {
+        fprintf(output, "%s\"%s\": %u", (0 < kind) ? ", " : "", kinds[kind].name, kinds[kind].weight);
+    }
+
+    fprintf(output, "},\n    \"injected\": {\"corrupted\": %u, \"truncated\": %u, \"garbage\": %u}},\n  \"results\": {\n",
+            stream.corrupted, stream.truncated, stream.garbage);
+
+    double seconds = bench_checksum(&stream, repeat);
+    fprintf(output, "    \"checksum\": {\"mb_per_s\": %.1f},\n", per_second(stream.length / 1e6, seconds));
+
+    seconds = bench_crc24q(&stream, repeat);
+    fprintf(output, "    \"crc24q\": {\"mb_per_s\": %.1f},\n", per_second(stream.length / 1e6, seconds));
+
+    seconds = bench_framer(&handle, &stream, chunk, repeat);
+    fprintf(output, "    \"framer\": {\"mb_per_s\": %.1f, \"frames_per_s\": %.0f, \"frames\": %llu, \"expected_frames\": %u, \"nmea\": %llu, \"expected_nmea\": %u, \"rtcm\": %llu, \"expected_rtcm\": %u},\n",
+            per_second(stream.length / 1e6, seconds), per_second(counters.frames, seconds), (unsigned long long)counters.frames, stream.ubx_frames,
+            (unsigned long long)counters.nmea, stream.nmea_sentences, (unsigned long long)counters.rtcm, stream.rtcm_frames);
+
+    // an intact stream has to come out complete, otherwise the numbers above measure a broken parser
+    if ((0 == stream.error_permille) &&
+        ((counters.frames != stream.ubx_frames) || (counters.nmea != stream.nmea_sentences) || (counters.rtcm != stream.rtcm_frames)))
+    {
+        fprintf(stderr, "framer lost messages of an intact stream\n");
+        status = 1;
+    }
+
+    seconds = bench_dispatch(&handle, repeat);
+    fprintf(output, "    \"dispatch\": {\"ns_per_frame\": %.1f},\n", seconds * 1e9 / BENCH_DISPATCH_FRAMES);
+
+    fprintf(output, "    \"decoders\": {");
+
+    for (int kind = BenchNavPVT; kind <= BenchNavTIMEUTC; kind++)
+    {
+        seconds = bench_decoder(&handle, kind, repeat);
+        fprintf(output, "%s\"nav_%s\": {\"ns_per_call\": %.1f}", (BenchNavPVT < kind) ? ", " : "", kinds[kind].name, seconds * 1e9 / BENCH_DECODER_CALLS);
+    }
+
+    fprintf(output, "},\n");
+
+    seconds = bench_replay(&handle, &stream, repeat);
+    fprintf(output, "    \"replay\": {\"mb_per_s\": %.1f}\n  }\n}\n", per_second(stream.length / 1e6, seconds));
+
+    if (stdout != output)
+    {
+        fclose(output);
+    }
+
+    free(stream.data);
+
+    return status;
+}
+
+#endif /* __linux__ */
@@ -27,45 +27,119 @@
 */
 
 #include <stddef.h>
+#include <string.h>
 
 #include "easyubx_drv.h"
+#include "easyubx_drv_bringup.h"
+#include "easyubx_drv_cfg.h"
 #include "easyubx_drv_consts.h"
+#include "easyubx_drv_demux.h"
+#include "easyubx_drv_epoch.h"
 #include "easyubx_drv_mon.h"
 #include "easyubx_drv_nav.h"
+#include "easyubx_drv_request.h"
+#include "easyubx_drv_sec.h"
+#include "easyubx_drv_stats.h"
+#include "easyubx_drv_warm.h"
 
 static void handle_receive_message(struct eubx_handle *pHandle);
-static void handle_receive_class_rxm(struct eubx_handle *pHandle);
-static void handle_receive_class_inf(struct eubx_handle *pHandle);
-static void handle_receive_class_ack(struct eubx_handle *pHandle);
-static void handle_receive_class_upd(struct eubx_handle *pHandle);
-static void handle_receive_class_aid(struct eubx_handle *pHandle);
-static void handle_receive_class_tim(struct eubx_handle *pHandle);
-static void handle_receive_class_esf(struct eubx_handle *pHandle);
-static void handle_receive_class_mga(struct eubx_handle *pHandle);
-static void handle_receive_class_log(struct eubx_handle *pHandle);
-static void handle_receive_class_sec(struct eubx_handle *pHandle);
-static void handle_receive_class_hnr(struct eubx_handle *pHandle);
-
-static void calculate_checksum(const struct eubx_message *message, uint8_t *ck_a, uint8_t *ck_b);
+static void handle_receive_ack_ack(struct eubx_handle *pHandle);
+static void handle_receive_ack_nak(struct eubx_handle *pHandle);
+static uint8_t user_handler_hash(uint8_t message_class, uint8_t message_id);
+static const struct eubx_user_handler *find_user_handler(const struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id);
+
+static const eubx_drv_handler ack_handlers[] = {
+    [EUBX_ID_ACK_NAK] = handle_receive_ack_nak,
+    [EUBX_ID_ACK_ACK] = handle_receive_ack_ack,
+};
+
+static const struct eubx_drv_length ack_lengths[] = {
+    [EUBX_ID_ACK_NAK] = {EUBX_LENGTH_ACK, EUBX_LENGTH_ACK},
+    [EUBX_ID_ACK_ACK] = {EUBX_LENGTH_ACK, EUBX_LENGTH_ACK},
+};
+
+static const struct eubx_drv_dispatch ack_dispatch = EUBX_DRV_DISPATCH_CHECKED(ack_handlers, ack_lengths);
+static const struct eubx_drv_dispatch no_dispatch = {NULL, 0, NULL, 0}; // known class without built in decoders
+
+// indexed by message class, NULL marks classes unknown to the library
+static const struct eubx_drv_dispatch *const class_dispatch[] = {
+    [EUBX_CLASS_NAV] = &eubx_drv_nav_dispatch,
+    [EUBX_CLASS_RXM] = &no_dispatch,
+    [EUBX_CLASS_INF] = &no_dispatch,
+    [EUBX_CLASS_ACK] = &ack_dispatch,
+    [EUBX_CLASS_CFG] = &eubx_drv_cfg_dispatch,
+    [EUBX_CLASS_UPD] = &no_dispatch,
+    [EUBX_CLASS_MON] = &eubx_drv_mon_dispatch,
+    [EUBX_CLASS_AID] = &no_dispatch,
+    [EUBX_CLASS_TIM] = &no_dispatch,
+    [EUBX_CLASS_ESF] = &no_dispatch,
+    [EUBX_CLASS_MGA] = &no_dispatch,
+    [EUBX_CLASS_LOG] = &no_dispatch,
+    [EUBX_CLASS_SEC] = &eubx_drv_sec_dispatch,
+    [EUBX_CLASS_HNR] = &no_dispatch,
+};
+
+static void receive_chunk(struct eubx_handle *pHandle, const uint8_t *position, const uint8_t *end);
+static const uint8_t *receive_sync(struct eubx_handle *pHandle, const uint8_t *position, const uint8_t *end);
+static const uint8_t *receive_content(struct eubx_handle *pHandle, const uint8_t *position, const uint8_t *end);
+static void receive_header_byte(struct eubx_handle *pHandle, uint8_t byte);
+static bool check_receive_length(struct eubx_handle *pHandle);
+static void rescan_frame(struct eubx_handle *pHandle, bool with_payload);
+
+static TEasyUBXError setup_storage(struct eubx_handle *pHandle, const struct eubx_init_options *options);
+static void commit_receive_message(struct eubx_handle *pHandle);
+
+static uint32_t read_time(struct eubx_handle *pHandle);
+static bool wait_for_input(struct eubx_handle *pHandle, uint32_t start, uint32_t *passes, uint32_t timeout_ms);
+static void record_send_rtt(struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id);
+
+static TEasyUBXError check_send_message(struct eubx_handle *pHandle);
+static uint16_t prepare_frame(struct eubx_handle *pHandle);
+static void emit_frame(struct eubx_handle *pHandle, const uint8_t *frame, uint16_t length);
 
 TEasyUBXError eubx_init(struct eubx_handle *pHandle, eubx_receive_buffer receive_buffer, eubx_send_byte send_byte, eubx_send_buffer send_buffer, eubx_notify_event notify_event, void *usr_ptr)
+{
+    return eubx_init_ex(pHandle, receive_buffer, send_byte, send_buffer, notify_event, usr_ptr, NULL);
+}
+
+TEasyUBXError eubx_init_ex(struct eubx_handle *pHandle, eubx_receive_buffer receive_buffer, eubx_send_byte send_byte, eubx_send_buffer send_buffer, eubx_notify_event notify_event, void *usr_ptr, const struct eubx_init_options *options)
 {
     TEasyUBXError rc = EUBX_ERROR_NULLPTR;
 
     if (NULL != pHandle)
+    {
+        rc = setup_storage(pHandle, options);
+    }
+
+    if (EUBX_ERROR_OK == rc)
     {
         pHandle->is_initialized = true;
         pHandle->last_error = EUBX_ERROR_OK;
 
         pHandle->receive_status = EUBXReceiveExpectSync1;
+        pHandle->receive_error = EUBX_ERROR_OK;
         pHandle->receive_message.message_class = 0;
         pHandle->receive_message.message_id = 0;
         pHandle->receive_message.message_length = 0;
         pHandle->receive_message.ck_a = 0;
         pHandle->receive_message.ck_b = 0;
+        pHandle->receive_ck_a = 0;
+        pHandle->receive_ck_b = 0;
         pHandle->receive_position = 0;
+        pHandle->fast_resync = (NULL != options) ? options->fast_resync : false;
+        pHandle->receive_rescanning = false;
 
         pHandle->last_event = EUBXEventNone;
+        pHandle->ack_class = 0;
+        pHandle->ack_id = 0;
+        pHandle->send_class = 0;
+        pHandle->send_id = 0;
+        pHandle->send_time = 0;
+        memset(pHandle->rtt_table, 0, sizeof(pHandle->rtt_table));
+        memset(pHandle->user_handlers, 0, sizeof(pHandle->user_handlers));
+        pHandle->default_handler = NULL;
+        pHandle->default_handler_usr_ptr = NULL;
+        pHandle->rtt_next = 0;
         pHandle->send_message.message_class = 0;
         pHandle->send_message.message_id = 0;
         pHandle->send_message.message_length = 0;
@@ -76,21 +150,66 @@ TEasyUBXError eubx_init(struct eubx_handle *pHandle, eubx_receive_buffer receive
         pHandle->send_byte = send_byte;
         pHandle->send_buffer = send_buffer;
         pHandle->notify_event = notify_event;
+        pHandle->notify_message = (NULL != options) ? options->notify_message : NULL;
+        pHandle->get_time = (NULL != options) ? options->get_time : NULL;
+        pHandle->wait_input = (NULL != options) ? options->wait_input : NULL;
+        pHandle->send_vector = (NULL != options) ? options->send_vector : NULL;
+        pHandle->notify_nmea = (NULL != options) ? options->notify_nmea : NULL;
+        pHandle->notify_rtcm = (NULL != options) ? options->notify_rtcm : NULL;
+        pHandle->tap = (NULL != options) ? options->tap : NULL;
+        pHandle->tap_usr_ptr = (NULL != options) ? options->tap_usr_ptr : NULL;
+        pHandle->set_baud = (NULL != options) ? options->set_baud : NULL;
+        pHandle->baud_rate = (NULL != options) ? options->baud_rate : 0;
         pHandle->callback_usr_ptr = usr_ptr;
+        pHandle->receive_time = 0;
+        pHandle->receive_timestamp = 0;
 
         pHandle->receiver_info.chipset_version = EUBXChipsetNotSet;
         pHandle->receiver_info.software_version[0] = 0;
+        pHandle->receiver_info.unique_id_length = 0;
 
         pHandle->receiver_config.dynamic_platform_model = EUBXPlatformModelNotSet;
         pHandle->receiver_config.fix_mode = EUBXFixModeNotSet;
         pHandle->receiver_config.measurement_rate = 0;
         pHandle->receiver_config.navigation_rate = 0;
-
-        eubx_poll_mon_version(pHandle);
-        eubx_poll_cfg_nav5(pHandle);
-        eubx_poll_cfg_rate(pHandle);
-
-        rc = pHandle->last_error;
+        pHandle->receiver_config.rate_time_reference = 0;
+        memset(&pHandle->receiver_config.gnss, 0, sizeof(pHandle->receiver_config.gnss));
+        memset(&pHandle->receiver_config.port, 0, sizeof(pHandle->receiver_config.port));
+
+        memset(&pHandle->nav_pvt, 0, sizeof(pHandle->nav_pvt));
+        memset(&pHandle->nav_posllh, 0, sizeof(pHandle->nav_posllh));
+        memset(&pHandle->nav_velned, 0, sizeof(pHandle->nav_velned));
+        memset(&pHandle->nav_sol, 0, sizeof(pHandle->nav_sol));
+        memset(&pHandle->nav_dop, 0, sizeof(pHandle->nav_dop));
+        memset(&pHandle->nav_timeutc, 0, sizeof(pHandle->nav_timeutc));
+        memset(&pHandle->mon_ports, 0, sizeof(pHandle->mon_ports));
+        memset(&pHandle->mon_hw, 0, sizeof(pHandle->mon_hw));
+        eubx_drv_epoch_reset(pHandle, (NULL != options) ? options->notify_epoch : NULL);
+        memset(pHandle->poll_schedule, 0, sizeof(pHandle->poll_schedule));
+        pHandle->message_plan = NULL;
+        pHandle->message_plan_count = 0;
+        pHandle->message_plan_matched = 0;
+
+        eubx_drv_request_reset(pHandle);
+        eubx_drv_stats_reset(pHandle);
+        pHandle->warm_status = EUBXWarmNone;
+        eubx_drv_bringup_reset(pHandle);
+
+        // a cached state is trusted right away and verified in the background
+        if ((NULL != options) && eubx_drv_warm_restore(pHandle, options->warm_state, options->warm_state_length))
+        {
+            rc = eubx_drv_warm_verify(pHandle);
+            pHandle->bringup_state = EUBXBringUpStateReady;
+            eubx_send_notification(pHandle, EUBXBringUpReady);
+        }
+        else if ((NULL != options) && options->nonblocking)
+        {
+            rc = eubx_start_bringup(pHandle);
+        }
+        else
+        {
+            rc = eubx_drv_bringup_run(pHandle);
+        }
     }
 
     return rc;
@@ -98,23 +217,66 @@ TEasyUBXError eubx_init(struct eubx_handle *pHandle, eubx_receive_buffer receive
 
 void eubx_loop(struct eubx_handle *pHandle)
 {
+    // before receiving, a poll sent afterwards would clear an event a wait has yet to see
+    eubx_drv_request_run_schedule(pHandle);
+    eubx_flush_queue(pHandle);
+
     if (pHandle->receive_buffer != NULL)
     {
-        uint8_t buffer[16];
-        uint16_t length = pHandle->receive_buffer(pHandle->callback_usr_ptr, buffer, sizeof(buffer));
+        uint8_t buffer[EUBX_RECEIVE_CHUNK_SIZE];
+        uint16_t length = 0;
+
+        // drain everything the transport has, a short read means it is empty
+        do
+        {
+            length = pHandle->receive_buffer(pHandle->callback_usr_ptr, buffer, sizeof(buffer));
+            eubx_receive_bytes(pHandle, buffer, length);
+        } while (sizeof(buffer) == length);
+    }
+
+    eubx_drv_request_check_timeouts(pHandle);
+    eubx_drv_epoch_check_timeout(pHandle);
+}
+
+uint32_t eubx_time_to_deadline(struct eubx_handle *pHandle)
+{
+    uint32_t remaining_us = EUBX_NO_DEADLINE;
+
+    if ((NULL != pHandle) && pHandle->is_initialized && (NULL != pHandle->get_time))
+    {
+        uint32_t now = read_time(pHandle);
+        uint32_t epoch_us = eubx_drv_epoch_time_to_deadline(pHandle, now);
+
+        remaining_us = eubx_drv_request_time_to_deadline(pHandle, now);
 
-        for (uint16_t i = 0; i < length; i++)
+        if (epoch_us < remaining_us)
         {
-            eubx_receive_byte(pHandle, buffer[i]);
+            remaining_us = epoch_us;
         }
     }
+
+    // rounded up, waking a little late is cheaper than waking twice
+    return (EUBX_NO_DEADLINE == remaining_us) ? EUBX_NO_DEADLINE : (remaining_us + 999) / 1000;
+}
+
+void eubx_run_timers(struct eubx_handle *pHandle)
+{
+    eubx_drv_request_run_schedule(pHandle);
+    eubx_flush_queue(pHandle);
+    eubx_drv_request_check_timeouts(pHandle);
+    eubx_drv_epoch_check_timeout(pHandle);
 }
 
 TEasyUBXError eubx_receive_byte(struct eubx_handle *pHandle, uint8_t byte)
+{
+    return eubx_receive_bytes(pHandle, &byte, 1);
+}
+
+TEasyUBXError eubx_receive_bytes(struct eubx_handle *pHandle, const uint8_t *buffer, size_t length)
 {
     TEasyUBXError rc = EUBX_ERROR_NULLPTR;
 
-    if (NULL != pHandle)
+    if ((NULL != pHandle) && ((NULL != buffer) || (0 == length)))
     {
         if (pHandle->is_initialized)
         {
@@ -128,131 +290,152 @@ TEasyUBXError eubx_receive_byte(struct eubx_handle *pHandle, uint8_t byte)
 
     if (EUBX_ERROR_OK == rc)
     {
-        pHandle->last_error = EUBX_ERROR_OK;
+        if (NULL != pHandle->get_time)
+        {
+            pHandle->receive_time = pHandle->get_time(pHandle->callback_usr_ptr);
+        }
 
-        switch (pHandle->receive_status)
+        if ((NULL != pHandle->tap) && (0 < length))
         {
-        case EUBXReceiveExpectSync1:
-            if (EUBX_SYNC1 == byte)
-            {
-                pHandle->receive_status = EUBXReceiveExpectSync2;
-            }
-            break;
+            pHandle->tap(pHandle->tap_usr_ptr, EUBXDirectionRx, buffer, length);
+        }
 
-        case EUBXReceiveExpectSync2:
-            if (EUBX_SYNC2 == byte)
-            {
-                pHandle->receive_status = EUBXReceiveExpectClass;
-            }
-            else
-            {
-                pHandle->receive_status = EUBXReceiveExpectSync1;
-            }
-            break;
+        // errors of earlier calls or of waits must not show up as errors of this chunk
+        pHandle->last_error = EUBX_ERROR_OK;
+        EUBX_DRV_STATS_ADD(pHandle, bytes_in, length);
+        receive_chunk(pHandle, buffer, buffer + length);
 
-        case EUBXReceiveExpectClass:
-            pHandle->receive_message.message_class = byte;
-            pHandle->receive_status = EUBXReceiveExpectId;
-            break;
+        rc = pHandle->last_error;
+    }
 
-        case EUBXReceiveExpectId:
-            pHandle->receive_message.message_id = byte;
-            pHandle->receive_status = EUBXReceiveExpectLength1;
-            break;
+    return rc;
+}
 
-        case EUBXReceiveExpectLength1:
-            pHandle->receive_message.message_length = byte;
-            pHandle->receive_status = EUBXReceiveExpectLength2;
-            break;
+TEasyUBXError eubx_send_message(struct eubx_handle *pHandle)
+{
+    TEasyUBXError rc = check_send_message(pHandle);
 
-        case EUBXReceiveExpectLength2:
-            pHandle->receive_message.message_length = pHandle->receive_message.message_length + (256 * (uint16_t)byte);
-            if (0 == pHandle->receive_message.message_length)
-            {
-                pHandle->receive_status = EUBXReceiveExpectCKA;
-            }
-            else
-            {
-                pHandle->receive_status = EUBXReceiveExpectContent;
-                pHandle->receive_position = 0;
-            }
-            break;
+    if (EUBX_ERROR_OK == rc)
+    {
+        uint16_t length = 0;
 
-        case EUBXReceiveExpectContent:
-            if (EUBX_MESSAGE_BUFFER_SIZE < pHandle->receive_position)
-            {
-                pHandle->last_error = EUBX_ERROR_RECEIVE_OVERFLOW;
-            }
-            else
-            {
-                pHandle->receive_message.message_buffer[pHandle->receive_position] = byte;
-            }
-            pHandle->receive_position += 1;
-            if (pHandle->receive_position == pHandle->receive_message.message_length)
-            {
-                pHandle->receive_status = EUBXReceiveExpectCKA;
-            }
-            break;
+        // keeps the order with frames queued before, the request engine matches ACKs in that order
+        eubx_flush_queue(pHandle);
+        length = prepare_frame(pHandle);
 
-        case EUBXReceiveExpectCKA:
-            pHandle->receive_message.ck_a = byte;
-            pHandle->receive_status = EUBXReceiveExpectCKB;
-            break;
+        emit_frame(pHandle, pHandle->send_message.message_buffer - EUBX_FRAME_HEADER_LENGTH, length);
+    }
 
-        case EUBXReceiveExpectCKB:
-            pHandle->receive_message.ck_b = byte;
-            if (EUBX_ERROR_OK == pHandle->last_error)
-            {
-                handle_receive_message(pHandle);
-            }
-            pHandle->receive_status = EUBXReceiveExpectSync1;
-            break;
+    return rc;
+}
 
-        default:
-            pHandle->receive_status = EUBXReceiveExpectSync1;
-            break;
-        }
+TEasyUBXError eubx_send_frame(struct eubx_handle *pHandle, const uint8_t *frame, uint16_t length)
+{
+    TEasyUBXError rc = EUBX_ERROR_NULLPTR;
 
-        rc = pHandle->last_error;
+    if ((NULL != pHandle) && (NULL != frame) && ((NULL != pHandle->send_byte) || (NULL != pHandle->send_buffer)))
+    {
+        rc = (EUBX_FRAME_OVERHEAD <= length) ? EUBX_ERROR_OK : EUBX_ERROR_LENGTH;
+    }
+
+    if (EUBX_ERROR_OK == rc)
+    {
+        // keeps the order with frames queued before
+        eubx_flush_queue(pHandle);
+
+        pHandle->last_event = EUBXEventNone;
+        pHandle->send_class = frame[2];
+        pHandle->send_id = frame[3];
+        pHandle->send_time = read_time(pHandle);
+
+        emit_frame(pHandle, frame, length);
     }
 
     return rc;
 }
 
-TEasyUBXError eubx_send_message(struct eubx_handle *pHandle)
+TEasyUBXError eubx_queue_message(struct eubx_handle *pHandle, TEasyUBXPriority priority)
 {
-    TEasyUBXError rc = EUBX_ERROR_NULLPTR;
+    TEasyUBXError rc = check_send_message(pHandle);
 
-    if ((NULL != pHandle) && (NULL != pHandle->send_byte))
+    if ((EUBX_ERROR_OK == rc) && (NULL == pHandle->tx_queue))
     {
-        pHandle->last_event = EUBXEventNone;
+        rc = eubx_send_message(pHandle);
+    }
+    else if (EUBX_ERROR_OK == rc)
+    {
+        uint16_t length = prepare_frame(pHandle);
 
-        calculate_checksum(&pHandle->send_message, &pHandle->send_message.ck_a, &pHandle->send_message.ck_b);
+        if ((EUBX_TX_QUEUE_DEPTH == pHandle->tx_queue_count) || (pHandle->tx_queue_size - pHandle->tx_queue_used < length))
+        {
+            eubx_flush_queue(pHandle);
+        }
 
-        pHandle->send_byte(pHandle->callback_usr_ptr, EUBX_SYNC1);
-        pHandle->send_byte(pHandle->callback_usr_ptr, EUBX_SYNC2);
-        pHandle->send_byte(pHandle->callback_usr_ptr, pHandle->send_message.message_class);
-        pHandle->send_byte(pHandle->callback_usr_ptr, pHandle->send_message.message_id);
-        pHandle->send_byte(pHandle->callback_usr_ptr, pHandle->send_message.message_length % 256);
-        pHandle->send_byte(pHandle->callback_usr_ptr, pHandle->send_message.message_length / 256);
-        if (NULL != pHandle->send_buffer)
+        if (pHandle->tx_queue_size < length)
         {
-            pHandle->send_buffer(pHandle->callback_usr_ptr, pHandle->send_message.message_buffer, pHandle->send_message.message_length);
+            // does not fit into the queue at all, goes out on its own
+            emit_frame(pHandle, pHandle->send_message.message_buffer - EUBX_FRAME_HEADER_LENGTH, length);
         }
         else
         {
-            for (int i = 0; i < pHandle->send_message.message_length; i++)
+            struct eubx_tx_entry *entry = &pHandle->tx_queue_entries[pHandle->tx_queue_count++];
+
+            memcpy(&pHandle->tx_queue[pHandle->tx_queue_used], pHandle->send_message.message_buffer - EUBX_FRAME_HEADER_LENGTH, length);
+            entry->offset = pHandle->tx_queue_used;
+            entry->length = length;
+            entry->priority = priority;
+            pHandle->tx_queue_used += length;
+        }
+    }
+
+    return rc;
+}
+
+void eubx_flush_queue(struct eubx_handle *pHandle)
+{
+    if (0 < pHandle->tx_queue_count)
+    {
+        struct eubx_tx_segment segments[EUBX_TX_QUEUE_DEPTH];
+        uint8_t count = 0;
+
+        // stable by priority, frames of equal priority keep their order
+        for (int priority = EUBXPriorityHigh; priority <= EUBXPriorityLow; priority++)
+        {
+            for (int i = 0; i < pHandle->tx_queue_count; i++)
             {
-                pHandle->send_byte(pHandle->callback_usr_ptr, pHandle->send_message.message_buffer[i]);
+                if (priority == pHandle->tx_queue_entries[i].priority)
+                {
+                    segments[count].buffer = &pHandle->tx_queue[pHandle->tx_queue_entries[i].offset];
+                    segments[count].length = pHandle->tx_queue_entries[i].length;
+                    count++;
+                }
             }
         }
-        pHandle->send_byte(pHandle->callback_usr_ptr, pHandle->send_message.ck_a);
-        pHandle->send_byte(pHandle->callback_usr_ptr, pHandle->send_message.ck_b);
 
-        rc = EUBX_ERROR_OK;
-    }
+        if (NULL != pHandle->send_vector)
+        {
+            for (int i = 0; (i < count) && (NULL != pHandle->tap); i++)
+            {
+                pHandle->tap(pHandle->tap_usr_ptr, EUBXDirectionTx, segments[i].buffer, segments[i].length);
+            }
 
-    return rc;
+            pHandle->send_vector(pHandle->callback_usr_ptr, segments, count);
+        }
+        else
+        {
+            for (int i = 0; i < count; i++)
+            {
+                emit_frame(pHandle, segments[i].buffer, segments[i].length);
+            }
+        }
+
+        pHandle->tx_queue_count = 0;
+        pHandle->tx_queue_used = 0;
+
+        // frames prepared before went out now, waits and requests measure their round trip from here
+        pHandle->send_time = read_time(pHandle);
+        eubx_drv_request_mark_sent(pHandle, pHandle->send_time);
+    }
 }
 
 TEasyUBXError eubx_send_message_wait4ack(struct eubx_handle * pHandle, uint8_t message_class, uint8_t message_id)
@@ -269,207 +452,962 @@ TEasyUBXError eubx_send_message_wait4ack(struct eubx_handle * pHandle, uint8_t m
 
 TEasyUBXError eubx_waitfor_event(struct eubx_handle *pHandle, TEasyUBXEvent event)
 {
-    while (event != pHandle->last_event)
-    {
-        eubx_loop(pHandle);
-    }
-
-    return EUBX_ERROR_OK;
+    return eubx_waitfor_event_timeout(pHandle, event, eubx_get_timeout(pHandle, pHandle->send_class, pHandle->send_id));
 }
 
-TEasyUBXError eubx_waitfor_ack(struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id)
+TEasyUBXError eubx_waitfor_event_timeout(struct eubx_handle *pHandle, TEasyUBXEvent event, uint32_t timeout_ms)
 {
     TEasyUBXError rc = EUBX_ERROR_OK;
+    uint32_t start = read_time(pHandle);
+    uint32_t passes = 0;
 
-    while (
-        !(
-            ((EUBXReceivedACK == pHandle->last_event) || (EUBXReceivedNAK == pHandle->last_event)) && 
-            (message_class == pHandle->receive_message.message_buffer[0]) &&
-            (message_id == pHandle->receive_message.message_buffer[1])
-        )
-        )
+    eubx_flush_queue(pHandle);
+
+    while (event != pHandle->last_event)
     {
+        if (!wait_for_input(pHandle, start, &passes, timeout_ms))
+        {
+            EUBX_DRV_STATS_COUNT(pHandle, timeouts);
+            rc = EUBX_ERROR_TIMEOUT;
+            break;
+        }
+
         eubx_loop(pHandle);
     }
 
-    if (EUBXReceivedNAK == pHandle->last_event)
+    if (EUBX_ERROR_OK == rc)
     {
-        rc = EUBX_ERROR_NAK;
+        record_send_rtt(pHandle, pHandle->send_class, pHandle->send_id);
+    }
+    else
+    {
+        pHandle->last_error = rc;
     }
 
     return rc;
 }
 
-TEasyUBXError eubx_send_notification(struct eubx_handle *pHandle, TEasyUBXEvent event)
+TEasyUBXError eubx_waitfor_requests(struct eubx_handle *pHandle)
 {
-    TEasyUBXError rc = EUBX_ERROR_NULLPTR;
+    TEasyUBXError rc = EUBX_ERROR_OK;
+    uint32_t start = read_time(pHandle);
+    uint32_t passes = 0;
 
-    if (NULL != pHandle)
-    {
-        pHandle->last_event = event;
+    eubx_flush_queue(pHandle);
 
-        if (NULL != pHandle->notify_event)
+    // every request times out on its own, the overall limit only guards against a stalled clock
+    while (0 < pHandle->pending_requests)
+    {
+        if (!wait_for_input(pHandle, start, &passes, EUBX_TIMEOUT_MAX_MS * EUBX_MAX_PENDING_REQUESTS))
         {
-            pHandle->notify_event(pHandle->callback_usr_ptr, event);
+            EUBX_DRV_STATS_COUNT(pHandle, timeouts);
+            eubx_drv_request_reset(pHandle);
+            pHandle->request_error = EUBX_ERROR_TIMEOUT;
+            break;
         }
+
+        eubx_loop(pHandle);
+    }
+
+    rc = pHandle->request_error;
+    pHandle->request_error = EUBX_ERROR_OK;
+
+    if (EUBX_ERROR_OK != rc)
+    {
+        pHandle->last_error = rc;
     }
+
+    return rc;
 }
 
-void handle_receive_message(struct eubx_handle *pHandle)
+TEasyUBXError eubx_waitfor_ack(struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id)
+{
+    return eubx_waitfor_ack_timeout(pHandle, message_class, message_id, eubx_get_timeout(pHandle, message_class, message_id));
+}
+
+TEasyUBXError eubx_waitfor_ack_timeout(struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id, uint32_t timeout_ms)
 {
-    uint8_t ck_a = 0;
-    uint8_t ck_b = 0;
+    TEasyUBXError rc = EUBX_ERROR_OK;
+    uint32_t start = read_time(pHandle);
+    uint32_t passes = 0;
 
-    calculate_checksum(&pHandle->receive_message, &ck_a, &ck_b);
+    eubx_flush_queue(pHandle);
 
-    if ((ck_a == pHandle->receive_message.ck_a) && (ck_b == pHandle->receive_message.ck_b))
+    while (
+        !(
+            ((EUBXReceivedACK == pHandle->last_event) || (EUBXReceivedNAK == pHandle->last_event)) &&
+            (message_class == pHandle->ack_class) &&
+            (message_id == pHandle->ack_id)
+        )
+        )
     {
-        switch (pHandle->receive_message.message_class)
+        if (!wait_for_input(pHandle, start, &passes, timeout_ms))
         {
-        case EUBX_CLASS_NAV:
-            eubx_drv_handle_receive_class_nav(pHandle);
-            break;
-
-        case EUBX_CLASS_RXM:
-            handle_receive_class_rxm(pHandle);
+            EUBX_DRV_STATS_COUNT(pHandle, timeouts);
+            rc = EUBX_ERROR_TIMEOUT;
             break;
+        }
 
-        case EUBX_CLASS_INF:
-            handle_receive_class_inf(pHandle);
-            break;
+        eubx_loop(pHandle);
+    }
 
-        case EUBX_CLASS_ACK:
-            handle_receive_class_ack(pHandle);
-            break;
+    if (EUBX_ERROR_OK == rc)
+    {
+        record_send_rtt(pHandle, message_class, message_id);
 
-        case EUBX_CLASS_CFG:
-            eubx_drv_handle_receive_class_cfg(pHandle);
-            break;
+        if (EUBXReceivedNAK == pHandle->last_event)
+        {
+            rc = EUBX_ERROR_NAK;
+        }
+    }
 
-        case EUBX_CLASS_UPD:
-            handle_receive_class_upd(pHandle);
-            break;
+    if (EUBX_ERROR_OK != rc)
+    {
+        pHandle->last_error = rc;
+    }
 
-        case EUBX_CLASS_MON:
-            eubx_drv_handle_receive_class_mon(pHandle);
-            break;
+    return rc;
+}
 
-        case EUBX_CLASS_AID:
-            handle_receive_class_aid(pHandle);
-            break;
+uint32_t eubx_get_timeout(const struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id)
+{
+    uint32_t timeout_ms = EUBX_TIMEOUT_DEFAULT_MS;
 
-        case EUBX_CLASS_TIM:
-            handle_receive_class_tim(pHandle);
-            break;
+    for (int i = 0; i < EUBX_RTT_TABLE_SIZE; i++)
+    {
+        const struct eubx_rtt_entry *entry = &pHandle->rtt_table[i];
 
-        case EUBX_CLASS_ESF:
-            handle_receive_class_esf(pHandle);
+        if ((0 < entry->samples) && (message_class == entry->message_class) && (message_id == entry->message_id))
+        {
+            timeout_ms = (entry->srtt_us + 4 * entry->rttvar_us) / 1000;
             break;
+        }
+    }
 
-        case EUBX_CLASS_MGA:
-            handle_receive_class_mga(pHandle);
-            break;
+    if (EUBX_TIMEOUT_MIN_MS > timeout_ms)
+    {
+        timeout_ms = EUBX_TIMEOUT_MIN_MS;
+    }
+    else if (EUBX_TIMEOUT_MAX_MS < timeout_ms)
+    {
+        timeout_ms = EUBX_TIMEOUT_MAX_MS;
+    }
 
-        case EUBX_CLASS_LOG:
-            handle_receive_class_log(pHandle);
-            break;
+    return timeout_ms;
+}
 
-        case EUBX_CLASS_SEC:
-            handle_receive_class_sec(pHandle);
-            break;
+void eubx_record_rtt(struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id, uint32_t rtt_us)
+{
+    struct eubx_rtt_entry *entry = NULL;
 
-        case EUBX_CLASS_HNR:
-            handle_receive_class_hnr(pHandle);
-            break;
+    EUBX_DRV_STATS_RTT(pHandle, rtt_us);
 
-        default:
-            pHandle->last_error = EUBX_ERROR_UNKNOWN_CLASS;
+    for (int i = 0; i < EUBX_RTT_TABLE_SIZE; i++)
+    {
+        if ((0 < pHandle->rtt_table[i].samples) && (message_class == pHandle->rtt_table[i].message_class) && (message_id == pHandle->rtt_table[i].message_id))
+        {
+            entry = &pHandle->rtt_table[i];
             break;
         }
     }
+
+    if (NULL == entry)
+    {
+        // unknown message, take over the next slot round robin
+        entry = &pHandle->rtt_table[pHandle->rtt_next];
+        pHandle->rtt_next = (pHandle->rtt_next + 1) % EUBX_RTT_TABLE_SIZE;
+
+        entry->message_class = message_class;
+        entry->message_id = message_id;
+        entry->samples = 0;
+    }
+
+    if (0 == entry->samples)
+    {
+        entry->srtt_us = rtt_us;
+        entry->rttvar_us = rtt_us / 2;
+    }
     else
     {
-        pHandle->last_error = EUBX_ERROR_CHECKSUM;
+        // smoothing as in RFC 6298 with alpha = 1/8 and beta = 1/4
+        uint32_t delta = (entry->srtt_us > rtt_us) ? (entry->srtt_us - rtt_us) : (rtt_us - entry->srtt_us);
+
+        entry->rttvar_us = entry->rttvar_us - entry->rttvar_us / 4 + delta / 4;
+        entry->srtt_us = entry->srtt_us - entry->srtt_us / 8 + rtt_us / 8;
     }
-}
 
-void handle_receive_class_rxm(struct eubx_handle *pHandle)
-{
+    if (UINT16_MAX > entry->samples)
+    {
+        entry->samples++;
+    }
 }
 
-void handle_receive_class_inf(struct eubx_handle *pHandle)
+TEasyUBXError eubx_send_notification(struct eubx_handle *pHandle, TEasyUBXEvent event)
 {
-}
+    TEasyUBXError rc = EUBX_ERROR_NULLPTR;
 
-void handle_receive_class_ack(struct eubx_handle *pHandle)
-{
-    switch (pHandle->receive_message.message_id)
+    if (NULL != pHandle)
     {
-    case EUBX_ID_ACK_ACK:
-        eubx_send_notification(pHandle, EUBXReceivedACK);
-        break;
+        pHandle->last_event = event;
 
-    case EUBX_ID_ACK_NAK:
-        eubx_send_notification(pHandle, EUBXReceivedNAK);
-        break;
+        if (NULL != pHandle->notify_event)
+        {
+            pHandle->notify_event(pHandle->callback_usr_ptr, event);
+        }
 
-    default:
-        break;
+        rc = EUBX_ERROR_OK;
     }
-}
 
-void handle_receive_class_upd(struct eubx_handle *pHandle)
-{
+    return rc;
 }
 
-void handle_receive_class_aid(struct eubx_handle *pHandle)
+TEasyUBXError eubx_retain_message(struct eubx_handle *pHandle, const struct eubx_message_view *view)
 {
-}
+    TEasyUBXError rc = EUBX_ERROR_NULLPTR;
 
-void handle_receive_class_tim(struct eubx_handle *pHandle)
-{
-}
+    if ((NULL != pHandle) && (NULL != view))
+    {
+        rc = EUBX_ERROR_OK;
+    }
 
-void handle_receive_class_esf(struct eubx_handle *pHandle)
-{
+    if ((EUBX_ERROR_OK == rc) && ((NULL == pHandle->receive_arena) || (EUBXArenaRing != pHandle->receive_arena_mode)))
+    {
+        rc = EUBX_ERROR_NOT_SUPPORTED;
+    }
+
+    if (EUBX_ERROR_OK == rc)
+    {
+        uint32_t offset = (uint32_t)(view->payload - pHandle->receive_arena);
+
+        // everything from the oldest retained payload up to the head is protected
+        if (!pHandle->receive_arena_retained)
+        {
+            // the head is still at the payload being handled, behind it only after a wrap
+            pHandle->receive_arena_tail = offset;
+            pHandle->receive_arena_retained = true;
+            pHandle->receive_arena_wrapped = (pHandle->receive_arena_head < offset);
+        }
+        pHandle->receive_arena_retain_end = offset + view->message_length;
+    }
+
+    return rc;
+}
+
+TEasyUBXError eubx_release_message(struct eubx_handle *pHandle, const struct eubx_message_view *view)
+{
+    TEasyUBXError rc = EUBX_ERROR_NULLPTR;
+
+    if ((NULL != pHandle) && (NULL != view))
+    {
+        rc = EUBX_ERROR_OK;
+    }
+
+    if ((EUBX_ERROR_OK == rc) && pHandle->receive_arena_retained)
+    {
+        uint32_t end = (uint32_t)(view->payload - pHandle->receive_arena) + view->message_length;
+
+        if (end == pHandle->receive_arena_retain_end)
+        {
+            pHandle->receive_arena_retained = false;
+            pHandle->receive_arena_wrapped = false;
+        }
+        else if (pHandle->receive_arena_wrapped && (end == pHandle->receive_arena_wrap_end))
+        {
+            // the rest of the lap is unused, the next retained payload is at the start
+            pHandle->receive_arena_tail = 0;
+            pHandle->receive_arena_wrapped = false;
+        }
+        else
+        {
+            pHandle->receive_arena_tail = end;
+        }
+    }
+
+    return rc;
+}
+
+void handle_receive_message(struct eubx_handle *pHandle)
+{
+    uint8_t message_class = pHandle->receive_message.message_class;
+    uint8_t message_id = pHandle->receive_message.message_id;
+    const struct eubx_drv_dispatch *dispatch = NULL;
+    eubx_drv_handler handler = NULL;
+    const struct eubx_user_handler *user_handler = find_user_handler(pHandle, message_class, message_id);
+    struct eubx_message_view view;
+
+    EUBX_DRV_STATS_FRAME(pHandle);
+
+    view.message_class = message_class;
+    view.message_id = message_id;
+    view.message_length = pHandle->receive_message.message_length;
+    view.payload = pHandle->receive_message.message_buffer;
+    view.timestamp = pHandle->receive_timestamp;
+
+    if (NULL != pHandle->notify_message)
+    {
+        pHandle->notify_message(pHandle->callback_usr_ptr, &view);
+    }
+
+    if (sizeof(class_dispatch) / sizeof(class_dispatch[0]) > message_class)
+    {
+        dispatch = class_dispatch[message_class];
+    }
+
+    if ((NULL != dispatch) && (dispatch->count > message_id))
+    {
+        handler = dispatch->handlers[message_id];
+    }
+
+    if (NULL != handler)
+    {
+        handler(pHandle);
+    }
+
+    if ((NULL != user_handler) && (NULL != user_handler->handler))
+    {
+        user_handler->handler(user_handler->usr_ptr, pHandle, &view);
+    }
+    else if ((NULL == handler) && (NULL != pHandle->default_handler))
+    {
+        pHandle->default_handler(pHandle->default_handler_usr_ptr, pHandle, &view);
+    }
+    else if (NULL == dispatch)
+    {
+        EUBX_DRV_STATS_COUNT(pHandle, unknown_classes);
+        pHandle->last_error = EUBX_ERROR_UNKNOWN_CLASS;
+    }
+
+    if (EUBX_CLASS_ACK != message_class)
+    {
+        eubx_drv_request_handle_message(pHandle);
+    }
+}
+
+void handle_receive_ack_ack(struct eubx_handle *pHandle)
+{
+    pHandle->ack_class = pHandle->receive_message.message_buffer[0];
+    pHandle->ack_id = pHandle->receive_message.message_buffer[1];
+    eubx_send_notification(pHandle, EUBXReceivedACK);
+    eubx_drv_request_handle_ack(pHandle, pHandle->ack_class, pHandle->ack_id, true);
+}
+
+void handle_receive_ack_nak(struct eubx_handle *pHandle)
+{
+    pHandle->ack_class = pHandle->receive_message.message_buffer[0];
+    pHandle->ack_id = pHandle->receive_message.message_buffer[1];
+    EUBX_DRV_STATS_COUNT(pHandle, naks);
+    eubx_send_notification(pHandle, EUBXReceivedNAK);
+    eubx_drv_request_handle_ack(pHandle, pHandle->ack_class, pHandle->ack_id, false);
+}
+
+TEasyUBXError eubx_register_handler(struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id, eubx_message_handler handler, void *usr_ptr)
+{
+    TEasyUBXError rc = EUBX_ERROR_BUSY;
+    uint8_t slot = user_handler_hash(message_class, message_id);
+
+    // open addressing with linear probing, entries are never removed so a NULL handler keeps its slot
+    for (int i = 0; i < EUBX_USER_HANDLER_TABLE_SIZE; i++)
+    {
+        struct eubx_user_handler *entry = &pHandle->user_handlers[(slot + i) % EUBX_USER_HANDLER_TABLE_SIZE];
+
+        if (!entry->in_use || ((message_class == entry->message_class) && (message_id == entry->message_id)))
+        {
+            entry->in_use = true;
+            entry->message_class = message_class;
+            entry->message_id = message_id;
+            entry->handler = handler;
+            entry->usr_ptr = usr_ptr;
+            rc = EUBX_ERROR_OK;
+            break;
+        }
+    }
+
+    return rc;
+}
+
+void eubx_set_default_handler(struct eubx_handle *pHandle, eubx_message_handler handler, void *usr_ptr)
+{
+    pHandle->default_handler = handler;
+    pHandle->default_handler_usr_ptr = usr_ptr;
+}
+
+uint8_t user_handler_hash(uint8_t message_class, uint8_t message_id)
+{
+    return (uint8_t)((message_class * 31 + message_id) % EUBX_USER_HANDLER_TABLE_SIZE);
+}
+
+const struct eubx_user_handler *find_user_handler(const struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id)
+{
+    const struct eubx_user_handler *found = NULL;
+    uint8_t slot = user_handler_hash(message_class, message_id);
+
+    for (int i = 0; i < EUBX_USER_HANDLER_TABLE_SIZE; i++)
+    {
+        const struct eubx_user_handler *entry = &pHandle->user_handlers[(slot + i) % EUBX_USER_HANDLER_TABLE_SIZE];
+
+        if (!entry->in_use)
+        {
+            break;
+        }
+
+        if ((message_class == entry->message_class) && (message_id == entry->message_id))
+        {
+            found = entry;
+            break;
+        }
+    }
+
+    return found;
+}
+
+void receive_chunk(struct eubx_handle *pHandle, const uint8_t *position, const uint8_t *end)
+{
+    while (position < end)
+    {
+        switch (pHandle->receive_status)
+        {
+        case EUBXReceiveExpectSync1:
+            position = receive_sync(pHandle, position, end);
+            break;
+
+        case EUBXReceiveExpectContent:
+            position = receive_content(pHandle, position, end);
+            break;
+
+        case EUBXReceiveNmea:
+            position = eubx_drv_demux_receive_nmea(pHandle, position, end);
+            break;
+
+        case EUBXReceiveRtcm:
+            position = eubx_drv_demux_receive_rtcm(pHandle, position, end);
+            break;
+
+        default:
+            receive_header_byte(pHandle, *position);
+            position++;
+            break;
+        }
+    }
+}
+
+const uint8_t *receive_sync(struct eubx_handle *pHandle, const uint8_t *position, const uint8_t *end)
+{
+    const uint8_t *sync = NULL;
+    const uint8_t *next = end;
+
+    if ((NULL == pHandle->notify_nmea) && (NULL == pHandle->notify_rtcm))
+    {
+        sync = (const uint8_t *)memchr(position, EUBX_SYNC1, end - position);
+    }
+    else
+    {
+        // UBX, NMEA and RTCM3 frames are told apart by their first byte
+        for (; (position < end) && (NULL == sync); position++)
+        {
+            if ((EUBX_SYNC1 == *position) || (('$' == *position) && (NULL != pHandle->notify_nmea)) || ((EUBX_RTCM3_PREAMBLE == *position) && (NULL != pHandle->notify_rtcm)))
+            {
+                sync = position;
+            }
+        }
+    }
+
+    if (NULL == sync)
+    {
+        next = end;
+    }
+    else if (EUBX_SYNC1 == *sync)
+    {
+        pHandle->receive_status = EUBXReceiveExpectSync2;
+        next = sync + 1;
+    }
+    else if ('$' == *sync)
+    {
+        next = eubx_drv_demux_start_nmea(pHandle, sync, end);
+    }
+    else
+    {
+        next = eubx_drv_demux_start_rtcm(pHandle, sync, end);
+    }
+
+    return next;
+}
+
+const uint8_t *receive_content(struct eubx_handle *pHandle, const uint8_t *position, const uint8_t *end)
+{
+    size_t count = pHandle->receive_message.message_length - pHandle->receive_position;
+    uint32_t capacity = pHandle->receive_message.message_buffer_size;
+
+    if ((size_t)(end - position) < count)
+    {
+        count = end - position;
+    }
+
+    if (pHandle->receive_position < capacity)
+    {
+        size_t stored = count;
+
+        if (capacity - pHandle->receive_position < stored)
+        {
+            stored = capacity - pHandle->receive_position;
+        }
+
+        // a rescanned payload is moved down within the same storage
+        memmove(&pHandle->receive_message.message_buffer[pHandle->receive_position], position, stored);
+    }
+
+    // bytes beyond the buffer are still part of the checksum
+    eubx_checksum_update(&pHandle->receive_ck_a, &pHandle->receive_ck_b, position, count);
+
+    if (capacity < pHandle->receive_position + count)
+    {
+        if (capacity >= pHandle->receive_position)
+        {
+            EUBX_DRV_STATS_COUNT(pHandle, overflows);
+        }
+        pHandle->receive_error = EUBX_ERROR_RECEIVE_OVERFLOW;
+        pHandle->last_error = EUBX_ERROR_RECEIVE_OVERFLOW;
+    }
+
+    pHandle->receive_position += count;
+    if (pHandle->receive_position == pHandle->receive_message.message_length)
+    {
+        pHandle->receive_status = EUBXReceiveExpectCKA;
+    }
+
+    return position + count;
+}
+
+void receive_header_byte(struct eubx_handle *pHandle, uint8_t byte)
+{
+    if ((EUBXReceiveExpectClass <= pHandle->receive_status) && (EUBXReceiveExpectLength2 >= pHandle->receive_status))
+    {
+        pHandle->receive_ck_a += byte;
+        pHandle->receive_ck_b += pHandle->receive_ck_a;
+    }
+
+    switch (pHandle->receive_status)
+    {
+    case EUBXReceiveExpectSync1:
+        if (EUBX_SYNC1 == byte)
+        {
+            pHandle->receive_status = EUBXReceiveExpectSync2;
+        }
+        break;
+
+    case EUBXReceiveExpectSync2:
+        if (EUBX_SYNC2 == byte)
+        {
+            pHandle->receive_error = EUBX_ERROR_OK;
+            pHandle->receive_timestamp = pHandle->receive_time;
+            pHandle->receive_ck_a = 0;
+            pHandle->receive_ck_b = 0;
+            pHandle->receive_status = EUBXReceiveExpectClass;
+        }
+        else if (EUBX_SYNC1 != byte)
+        {
+            pHandle->receive_status = EUBXReceiveExpectSync1;
+        }
+        break;
+
+    case EUBXReceiveExpectClass:
+        pHandle->receive_message.message_class = byte;
+        pHandle->receive_status = EUBXReceiveExpectId;
+        break;
+
+    case EUBXReceiveExpectId:
+        pHandle->receive_message.message_id = byte;
+        pHandle->receive_status = EUBXReceiveExpectLength1;
+        break;
+
+    case EUBXReceiveExpectLength1:
+        pHandle->receive_message.message_length = byte;
+        pHandle->receive_status = EUBXReceiveExpectLength2;
+        break;
+
+    case EUBXReceiveExpectLength2:
+        pHandle->receive_message.message_length = pHandle->receive_message.message_length + (256 * (uint16_t)byte);
+        pHandle->receive_position = 0;
+        if (0 < pHandle->receive_message.message_length)
+        {
+            eubx_drv_place_receive_message(pHandle);
+        }
+
+        if (pHandle->fast_resync && !check_receive_length(pHandle))
+        {
+            pHandle->receive_status = EUBXReceiveExpectSync1;
+            rescan_frame(pHandle, false);
+        }
+        else if (0 == pHandle->receive_message.message_length)
+        {
+            pHandle->receive_status = EUBXReceiveExpectCKA;
+        }
+        else
+        {
+            pHandle->receive_status = EUBXReceiveExpectContent;
+        }
+        break;
+
+    case EUBXReceiveExpectCKA:
+        pHandle->receive_message.ck_a = byte;
+        pHandle->receive_status = EUBXReceiveExpectCKB;
+        break;
+
+    case EUBXReceiveExpectCKB:
+        pHandle->receive_message.ck_b = byte;
+        pHandle->receive_status = EUBXReceiveExpectSync1;
+        if (EUBX_ERROR_OK != pHandle->receive_error)
+        {
+            // the payload did not fit, the frame is dropped
+        }
+        else if ((pHandle->receive_ck_a == pHandle->receive_message.ck_a) && (pHandle->receive_ck_b == pHandle->receive_message.ck_b))
+        {
+            handle_receive_message(pHandle);
+            commit_receive_message(pHandle);
+        }
+        else
+        {
+            EUBX_DRV_STATS_COUNT(pHandle, checksum_errors);
+            pHandle->last_error = EUBX_ERROR_CHECKSUM;
+
+            // frames found while rescanning are not rescanned themselves, that bounds the recursion
+            if (pHandle->fast_resync && !pHandle->receive_rescanning)
+            {
+                rescan_frame(pHandle, true);
+            }
+        }
+        break;
+
+    default:
+        pHandle->receive_status = EUBXReceiveExpectSync1;
+        break;
+    }
+}
+
+bool check_receive_length(struct eubx_handle *pHandle)
+{
+    uint8_t message_class = pHandle->receive_message.message_class;
+    uint8_t message_id = pHandle->receive_message.message_id;
+    uint16_t length = pHandle->receive_message.message_length;
+    const struct eubx_drv_dispatch *dispatch = NULL;
+    const struct eubx_drv_length *expected = NULL;
+
+    if (sizeof(class_dispatch) / sizeof(class_dispatch[0]) > message_class)
+    {
+        dispatch = class_dispatch[message_class];
+    }
+
+    if ((NULL != dispatch) && (dispatch->length_count > message_id))
+    {
+        expected = &dispatch->lengths[message_id];
+    }
+
+    if (pHandle->receive_message.message_buffer_size < length)
+    {
+        EUBX_DRV_STATS_COUNT(pHandle, overflows);
+        pHandle->receive_error = EUBX_ERROR_RECEIVE_OVERFLOW;
+    }
+    else if ((NULL != expected) && (0 < expected->max) && ((expected->min > length) || (expected->max < length)))
+    {
+        EUBX_DRV_STATS_COUNT(pHandle, length_errors);
+        pHandle->receive_error = EUBX_ERROR_LENGTH;
+    }
+
+    if (EUBX_ERROR_OK != pHandle->receive_error)
+    {
+        pHandle->last_error = pHandle->receive_error;
+    }
+
+    return EUBX_ERROR_OK == pHandle->receive_error;
+}
+
+/*
+ * Feeds everything behind the sync bytes of a rejected frame through the parser again.
+ * A frame found in there is stored in front of the bytes still to be scanned, so the
+ * payload can be rescanned in place without a copy. The header bytes only go through the
+ * UBX states, an NMEA sentence or RTCM3 frame starting there would overwrite the payload
+ * before it is scanned.
+ */
+void rescan_frame(struct eubx_handle *pHandle, bool with_payload)
+{
+    bool rescanning = pHandle->receive_rescanning;
+    const uint8_t *payload = pHandle->receive_message.message_buffer;
+    uint16_t length = pHandle->receive_message.message_length;
+    uint8_t header[4];
+    uint8_t checksum[2];
+
+    header[0] = pHandle->receive_message.message_class;
+    header[1] = pHandle->receive_message.message_id;
+    header[2] = length % 256;
+    header[3] = length / 256;
+    checksum[0] = pHandle->receive_message.ck_a;
+    checksum[1] = pHandle->receive_message.ck_b;
+
+    EUBX_DRV_STATS_COUNT(pHandle, resyncs);
+    pHandle->receive_rescanning = true;
+
+    for (size_t i = 0; i < sizeof(header); i++)
+    {
+        receive_header_byte(pHandle, header[i]);
+    }
+
+    if (with_payload)
+    {
+        receive_chunk(pHandle, payload, payload + length);
+        receive_chunk(pHandle, checksum, checksum + sizeof(checksum));
+    }
+
+    pHandle->receive_rescanning = rescanning;
+}
+
+TEasyUBXError setup_storage(struct eubx_handle *pHandle, const struct eubx_init_options *options)
+{
+    TEasyUBXError rc = EUBX_ERROR_OK;
+
+    pHandle->receive_arena = NULL;
+    pHandle->receive_arena_size = 0;
+    pHandle->receive_arena_mode = EUBXArenaSlab;
+    pHandle->receive_arena_head = 0;
+    pHandle->receive_arena_tail = 0;
+    pHandle->receive_arena_retain_end = 0;
+    pHandle->receive_arena_retained = false;
+    pHandle->receive_arena_wrapped = false;
+    pHandle->receive_arena_wrap_end = 0;
+
+    pHandle->tx_queue = NULL;
+    pHandle->tx_queue_size = 0;
+    pHandle->tx_queue_used = 0;
+    pHandle->tx_queue_count = 0;
+
+#if EUBX_MESSAGE_BUFFER_SIZE > 0
+    pHandle->receive_message.message_buffer = pHandle->receive_storage;
+    pHandle->receive_message.message_buffer_size = EUBX_MESSAGE_BUFFER_SIZE;
+    pHandle->send_message.message_buffer = &pHandle->send_storage[EUBX_FRAME_HEADER_LENGTH];
+    pHandle->send_message.message_buffer_size = EUBX_MESSAGE_BUFFER_SIZE;
+#else
+    pHandle->receive_message.message_buffer = NULL;
+    pHandle->receive_message.message_buffer_size = 0;
+    pHandle->send_message.message_buffer = NULL;
+    pHandle->send_message.message_buffer_size = 0;
+#endif
+
+    if (NULL != options)
+    {
+        if ((NULL != options->receive_arena) && (0 < options->receive_arena_size))
+        {
+            pHandle->receive_arena = options->receive_arena;
+            pHandle->receive_arena_size = options->receive_arena_size;
+            pHandle->receive_arena_mode = options->receive_arena_mode;
+            pHandle->receive_message.message_buffer = options->receive_arena;
+            pHandle->receive_message.message_buffer_size = options->receive_arena_size;
+        }
+
+        if ((NULL != options->send_arena) && (EUBX_FRAME_OVERHEAD < options->send_arena_size))
+        {
+            pHandle->send_message.message_buffer = &options->send_arena[EUBX_FRAME_HEADER_LENGTH];
+            pHandle->send_message.message_buffer_size = options->send_arena_size - EUBX_FRAME_OVERHEAD;
+        }
+
+        if ((NULL != options->tx_queue) && (0 < options->tx_queue_size))
+        {
+            pHandle->tx_queue = options->tx_queue;
+            pHandle->tx_queue_size = options->tx_queue_size;
+        }
+    }
+
+    if ((NULL == pHandle->receive_message.message_buffer) || (NULL == pHandle->send_message.message_buffer))
+    {
+        rc = EUBX_ERROR_NULLPTR;
+    }
+
+    return rc;
 }
 
-void handle_receive_class_mga(struct eubx_handle *pHandle)
+void eubx_drv_place_receive_message(struct eubx_handle *pHandle)
 {
+    if ((NULL != pHandle->receive_arena) && (EUBXArenaRing == pHandle->receive_arena_mode))
+    {
+        uint32_t limit = pHandle->receive_arena_size;
+
+        // once wrapped the head may reach the tail, then the arena is full rather than empty
+        if (pHandle->receive_arena_retained && pHandle->receive_arena_wrapped)
+        {
+            limit = pHandle->receive_arena_tail;
+        }
+        else if (limit - pHandle->receive_arena_head < pHandle->receive_message.message_length)
+        {
+            // a payload is always stored contiguously, wrap early if it does not fit in front of the end
+            pHandle->receive_arena_wrap_end = pHandle->receive_arena_head;
+            pHandle->receive_arena_head = 0;
+            if (pHandle->receive_arena_retained)
+            {
+                pHandle->receive_arena_wrapped = true;
+                limit = pHandle->receive_arena_tail;
+            }
+        }
+
+        // a payload that does not fit in front of retained ones is reported as overflow
+        pHandle->receive_message.message_buffer = &pHandle->receive_arena[pHandle->receive_arena_head];
+        pHandle->receive_message.message_buffer_size = limit - pHandle->receive_arena_head;
+    }
 }
 
-void handle_receive_class_log(struct eubx_handle *pHandle)
+void commit_receive_message(struct eubx_handle *pHandle)
 {
+    if ((NULL != pHandle->receive_arena) && (EUBXArenaRing == pHandle->receive_arena_mode))
+    {
+        pHandle->receive_arena_head += pHandle->receive_message.message_length;
+    }
 }
 
-void handle_receive_class_sec(struct eubx_handle *pHandle)
+uint32_t read_time(struct eubx_handle *pHandle)
 {
+    uint32_t now = 0;
+
+    if (NULL != pHandle->get_time)
+    {
+        now = pHandle->get_time(pHandle->callback_usr_ptr);
+    }
+
+    return now;
 }
 
-void handle_receive_class_hnr(struct eubx_handle *pHandle)
+/*
+ * Without a clock the deadline is a number of passes: with wait_input each pass sleeps up
+ * to a millisecond, without it the wait spins EUBX_WAIT_SPINS_PER_MS passes per millisecond.
+ * Input arriving makes the passes shorter, a busy receiver gives up earlier than the timeout.
+ */
+bool wait_for_input(struct eubx_handle *pHandle, uint32_t start, uint32_t *passes, uint32_t timeout_ms)
 {
+    bool in_time = true;
+    uint32_t limit_ms = (EUBX_WAIT_LIMIT_MS < timeout_ms) ? EUBX_WAIT_LIMIT_MS : timeout_ms;
+
+    if (NULL != pHandle->get_time)
+    {
+        uint32_t elapsed_us = read_time(pHandle) - start;
+        uint32_t timeout_us = limit_ms * 1000;
+
+        if (elapsed_us >= timeout_us)
+        {
+            in_time = false;
+        }
+        else if (NULL != pHandle->wait_input)
+        {
+            pHandle->wait_input(pHandle->callback_usr_ptr, timeout_us - elapsed_us);
+        }
+    }
+    else if (NULL != pHandle->wait_input)
+    {
+        in_time = (*passes)++ < limit_ms;
+
+        if (in_time)
+        {
+            pHandle->wait_input(pHandle->callback_usr_ptr, 1000);
+        }
+    }
+    else
+    {
+        in_time = (*passes)++ / EUBX_WAIT_SPINS_PER_MS < limit_ms;
+    }
+
+    return in_time;
+}
+
+void record_send_rtt(struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id)
+{
+    if ((NULL != pHandle->get_time) && (message_class == pHandle->send_class) && (message_id == pHandle->send_id))
+    {
+        eubx_record_rtt(pHandle, message_class, message_id, read_time(pHandle) - pHandle->send_time);
+    }
+}
+
+TEasyUBXError check_send_message(struct eubx_handle *pHandle)
+{
+    TEasyUBXError rc = EUBX_ERROR_NULLPTR;
+
+    if ((NULL != pHandle) && ((NULL != pHandle->send_byte) || (NULL != pHandle->send_buffer)))
+    {
+        rc = EUBX_ERROR_OK;
+    }
+
+    if ((EUBX_ERROR_OK == rc) && (pHandle->send_message.message_buffer_size < pHandle->send_message.message_length))
+    {
+        rc = EUBX_ERROR_SEND_OVERFLOW;
+    }
+
+    return rc;
 }
 
-void calculate_checksum(const struct eubx_message *message, uint8_t *ck_a, uint8_t *ck_b)
+uint16_t prepare_frame(struct eubx_handle *pHandle)
 {
-    *ck_a = 0;
-    *ck_b = 0;
+    // the payload is preceded by room for the header and followed by room for the checksum
+    uint8_t *frame = pHandle->send_message.message_buffer - EUBX_FRAME_HEADER_LENGTH;
+    uint16_t length = pHandle->send_message.message_length;
+
+    frame[0] = EUBX_SYNC1;
+    frame[1] = EUBX_SYNC2;
+    frame[2] = pHandle->send_message.message_class;
+    frame[3] = pHandle->send_message.message_id;
+    frame[4] = length % 256;
+    frame[5] = length / 256;
+
+    pHandle->send_message.ck_a = 0;
+    pHandle->send_message.ck_b = 0;
+    eubx_checksum_update(&pHandle->send_message.ck_a, &pHandle->send_message.ck_b, &frame[2], length + 4);
+
+    frame[EUBX_FRAME_HEADER_LENGTH + length] = pHandle->send_message.ck_a;
+    frame[EUBX_FRAME_HEADER_LENGTH + length + 1] = pHandle->send_message.ck_b;
+
+    pHandle->last_event = EUBXEventNone;
+    pHandle->send_class = pHandle->send_message.message_class;
+    pHandle->send_id = pHandle->send_message.message_id;
+    pHandle->send_time = read_time(pHandle);
+
+    return length + EUBX_FRAME_OVERHEAD;
+}
 
-    *ck_a = *ck_a + message->message_class;
-    *ck_b = *ck_b + *ck_a;
+void emit_frame(struct eubx_handle *pHandle, const uint8_t *frame, uint16_t length)
+{
+    if (NULL != pHandle->tap)
+    {
+        pHandle->tap(pHandle->tap_usr_ptr, EUBXDirectionTx, frame, length);
+    }
 
-    *ck_a = *ck_a + message->message_id;
-    *ck_b = *ck_b + *ck_a;
+    if (NULL != pHandle->send_buffer)
+    {
+        pHandle->send_buffer(pHandle->callback_usr_ptr, frame, length);
+    }
+    else
+    {
+        for (int i = 0; i < length; i++)
+        {
+            pHandle->send_byte(pHandle->callback_usr_ptr, frame[i]);
+        }
+    }
+}
 
-    *ck_a = *ck_a + message->message_length % 256;
-    *ck_b = *ck_b + *ck_a;
+void eubx_checksum_update(uint8_t *ck_a, uint8_t *ck_b, const uint8_t *buffer, size_t length)
+{
+    // the sums are kept modulo 2^32 which preserves them modulo 256
+    uint32_t a = *ck_a;
+    uint32_t b = *ck_b;
+    size_t i = 0;
 
-    *ck_a = *ck_a + message->message_length / 256;
-    *ck_b = *ck_b + *ck_a;
+    // eight bytes per step: b gains 8 * a plus the weighted block sum, a gains the block sum
+    for (; i + 8 <= length; i += 8)
+    {
+        const uint8_t *p = &buffer[i];
 
-    for (int i = 0; i < message->message_length; i++)
+        b += 8 * a + 8 * (uint32_t)p[0] + 7 * (uint32_t)p[1] + 6 * (uint32_t)p[2] + 5 * (uint32_t)p[3] +
+             4 * (uint32_t)p[4] + 3 * (uint32_t)p[5] + 2 * (uint32_t)p[6] + (uint32_t)p[7];
+        a += (uint32_t)p[0] + p[1] + p[2] + p[3] + p[4] + p[5] + p[6] + p[7];
+    }
+
+    for (; i < length; i++)
     {
-        *ck_a = *ck_a + message->message_buffer[i];
-        *ck_b = *ck_b + *ck_a;
+        a += buffer[i];
+        b += a;
     }
+
+    *ck_a = (uint8_t)a;
+    *ck_b = (uint8_t)b;
 }
@@ -30,6 +30,7 @@
 #define EASYUBX_DRV_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -37,8 +38,119 @@ extern "C"
 {
 #endif
 
-#define EUBX_MESSAGE_BUFFER_SIZE 128
+#ifndef EUBX_MESSAGE_BUFFER_SIZE
+#define EUBX_MESSAGE_BUFFER_SIZE 128 // size of the embedded send and receive buffers, 0 requires caller supplied arenas
+#endif
 #define EUBX_SW_VERSION_LENGTH 24
+#define EUBX_UNIQUE_ID_LENGTH 6
+
+#ifndef EUBX_TIMEOUT_DEFAULT_MS
+#define EUBX_TIMEOUT_DEFAULT_MS 1000 // timeout for messages without round trip samples
+#endif
+#ifndef EUBX_TIMEOUT_MIN_MS
+#define EUBX_TIMEOUT_MIN_MS 100
+#endif
+#ifndef EUBX_TIMEOUT_MAX_MS
+#define EUBX_TIMEOUT_MAX_MS 5000
+#endif
+#define EUBX_WAIT_LIMIT_MS 4290000 // timeouts are cut to it, the microsecond clock wraps after 4294967 ms
+#ifndef EUBX_WAIT_SPINS_PER_MS
+#define EUBX_WAIT_SPINS_PER_MS 1000 // without get_time and wait_input, eubx_loop passes of a wait counted as a millisecond
+#endif
+#ifndef EUBX_RTT_TABLE_SIZE
+#define EUBX_RTT_TABLE_SIZE 8 // number of class/id pairs with round trip tracking
+#endif
+
+#ifndef EUBX_MAX_PENDING_REQUESTS
+#define EUBX_MAX_PENDING_REQUESTS 8 // requests that can be in flight at the same time
+#endif
+
+#ifndef EUBX_USER_HANDLER_TABLE_SIZE
+#define EUBX_USER_HANDLER_TABLE_SIZE 8 // class/id pairs with an application handler
+#endif
+
+#ifndef EUBX_TX_QUEUE_DEPTH
+#define EUBX_TX_QUEUE_DEPTH 8 // frames that can be queued for one batched write
+#endif
+
+#define EUBX_FRAME_HEADER_LENGTH 6 // sync, class, id and length in front of the payload
+#define EUBX_FRAME_OVERHEAD 8      // header plus the two checksum bytes
+
+#ifndef EUBX_CACHE_LINE_SIZE
+#define EUBX_CACHE_LINE_SIZE 32 // alignment of the decoded navigation data, 0 disables it
+#endif
+
+#if (EUBX_CACHE_LINE_SIZE > 0) && defined(__GNUC__)
+#define EUBX_CACHE_ALIGNED __attribute__((aligned(EUBX_CACHE_LINE_SIZE)))
+#else
+#define EUBX_CACHE_ALIGNED
+#endif
+
+#ifndef EUBX_NMEA_MAX_LENGTH
+#define EUBX_NMEA_MAX_LENGTH 120 // longest accepted sentence including "\r\n", leaves room for proprietary PUBX sentences
+#endif
+
+#ifndef EUBX_POLL_SCHEDULE_SIZE
+#define EUBX_POLL_SCHEDULE_SIZE 6 // class/id pairs polled periodically by eubx_loop
+#endif
+
+#define EUBX_MON_PORT_COUNT 6     // I2C, UART1, UART2, USB, SPI and a reserved one
+#define EUBX_MON_PROTOCOL_COUNT 8 // indexed by protocol, 0 UBX, 1 NMEA, 2 RTCM2, 5 RTCM3
+
+#ifndef EUBX_STATS_ENABLED
+#define EUBX_STATS_ENABLED 1 // per handle counters and latency histograms, see struct eubx_stats
+#endif
+#ifndef EUBX_STATS_MESSAGE_TABLE_SIZE
+#define EUBX_STATS_MESSAGE_TABLE_SIZE 16 // class/id pairs with their own frame counter
+#endif
+#define EUBX_STATS_HISTOGRAM_BUCKETS 16 // bucket i counts values below 2^(i + 1) us, the last one everything above
+
+#ifndef EUBX_NAV_EPOCH_ENABLED
+#define EUBX_NAV_EPOCH_ENABLED 1 // groups the NAV messages of an epoch, see struct eubx_nav_epoch
+#endif
+#ifndef EUBX_NAV_SNAPSHOT_ENABLED
+#define EUBX_NAV_SNAPSHOT_ENABLED EUBX_NAV_EPOCH_ENABLED // latest epoch readable from any thread
+#endif
+#if EUBX_NAV_SNAPSHOT_ENABLED && !EUBX_NAV_EPOCH_ENABLED
+#error "the navigation snapshot publishes the epochs of the assembler"
+#endif
+#ifndef EUBX_NAV_EPOCH_TIMEOUT_MS
+#define EUBX_NAV_EPOCH_TIMEOUT_MS 50 // quiet time closing an epoch of a receiver without NAV-EOE
+#endif
+#ifndef EUBX_NAV_EPOCH_LATE_MS
+#define EUBX_NAV_EPOCH_LATE_MS 10000 // an iTOW further back starts a new epoch, e.g. after a receiver reset
+#endif
+#define EUBX_NAV_MESSAGE_PVT 0x01 // bits of eubx_nav_epoch.messages
+#define EUBX_NAV_MESSAGE_POSLLH 0x02
+#define EUBX_NAV_MESSAGE_VELNED 0x04
+#define EUBX_NAV_MESSAGE_SOL 0x08
+#define EUBX_NAV_MESSAGE_DOP 0x10
+#define EUBX_NAV_MESSAGE_TIMEUTC 0x20
+
+#define EUBX_GNSS_BLOCK_COUNT 8 // constellations in CFG-GNSS
+#define EUBX_WARM_STATE_SIZE 124 // bytes written by eubx_save_warm_state
+#define EUBX_PORT_COUNT 6 // rate slots of CFG-MSG: I2C, UART1, UART2, USB, SPI and a reserved one
+#ifndef EUBX_MESSAGE_PLAN_SIZE
+#define EUBX_MESSAGE_PLAN_SIZE 32 // entries of one eubx_apply_message_plan call
+#endif
+
+#ifndef EUBX_LINK_PROBE_TIMEOUT_MS
+#define EUBX_LINK_PROBE_TIMEOUT_MS 200 // wait for a baud rate probe on top of the backlog below
+#endif
+#ifndef EUBX_LINK_PROBE_BACKLOG
+#define EUBX_LINK_PROBE_BACKLOG 512 // bytes the receiver may still have queued in front of the answer
+#endif
+#ifndef EUBX_LINK_PROBE_ATTEMPTS
+#define EUBX_LINK_PROBE_ATTEMPTS 2 // probes per candidate baud rate
+#endif
+#ifndef EUBX_LINK_LOAD_PERCENT
+#define EUBX_LINK_LOAD_PERCENT 80 // share of the link a message plan may use, the rest absorbs ACKs and polls
+#endif
+
+#ifndef EUBX_RECEIVE_CHUNK_SIZE
+#define EUBX_RECEIVE_CHUNK_SIZE 64 // bytes requested from the transport per read in eubx_loop
+#endif
+#define EUBX_NO_DEADLINE 0xffffffff // from eubx_time_to_deadline, nothing is due until data arrives
 
     typedef enum
     {
@@ -49,7 +161,12 @@ extern "C"
         EUBX_ERROR_RECEIVE_OVERFLOW = -4,
         EUBX_ERROR_UNKNOWN_CLASS = -5,
         EUBX_ERROR_NAK = -6,
-        EUBX_ERROR_TIMEOUT = -7
+        EUBX_ERROR_TIMEOUT = -7,
+        EUBX_ERROR_SEND_OVERFLOW = -8,
+        EUBX_ERROR_NOT_SUPPORTED = -9,
+        EUBX_ERROR_BUSY = -10,
+        EUBX_ERROR_LENGTH = -11,
+        EUBX_ERROR_BANDWIDTH = -12 // a message plan does not fit the baud rate
     } TEasyUBXError;
 
     typedef enum
@@ -62,7 +179,9 @@ extern "C"
         EUBXReceiveExpectLength2,
         EUBXReceiveExpectContent,
         EUBXReceiveExpectCKA,
-        EUBXReceiveExpectCKB
+        EUBXReceiveExpectCKB,
+        EUBXReceiveNmea, // collecting an NMEA sentence that started in an earlier chunk
+        EUBXReceiveRtcm  // collecting an RTCM3 frame that started in an earlier chunk
     } TEasyUBXReceiveStatus;
 
     typedef enum
@@ -76,6 +195,26 @@ extern "C"
         EUBXReceivedCfgRATE,
         EUBXReceivedMonGNSS,
         EUBXReceivedMonVersion,
+        EUBXReceivedNavPVT,
+        EUBXReceivedNavPOSLLH,
+        EUBXReceivedNavVELNED,
+        EUBXReceivedNavSOL,
+        EUBXReceivedNavDOP,
+        EUBXReceivedNavTIMEUTC,
+        EUBXReceivedSecUNIQID,
+        EUBXReceivedMonIO,
+        EUBXReceivedMonRXBUF,
+        EUBXReceivedMonTXBUF,
+        EUBXReceivedMonMSGPP,
+        EUBXReceivedMonHW,
+        EUBXReceivedCfgMSG,
+        EUBXReceivedCfgGNSS,
+        EUBXWarmStartVerified, // the receiver is the one the cached state belongs to
+        EUBXWarmStartMismatch, // the cached state was dropped, the configuration is polled again
+        EUBXBringUpProgress,   // the bring-up moved to the next step, see eubx_bringup_state
+        EUBXBringUpReady,      // receiver info and configuration are known
+        EUBXBringUpFailed,     // the receiver did not answer, eubx_start_bringup tries again
+        EUBXNavEpochPublished, // an epoch was closed, eubx_read_nav_snapshot returns it
 
         EUBXDebugMessage1 = 1000,
         EUBXDebugMessage2 = 1001
@@ -88,7 +227,201 @@ extern "C"
         uint16_t message_length;
         uint8_t ck_a;
         uint8_t ck_b;
-        uint8_t message_buffer[EUBX_MESSAGE_BUFFER_SIZE];
+        uint8_t *message_buffer;      // embedded storage or a slot in the caller supplied arena
+        uint32_t message_buffer_size; // bytes available at message_buffer
+    };
+
+    /*
+     * Read only view of a received frame handed to eubx_notify_message.
+     * The payload points into the receive storage and is only valid until the callback returns.
+     * With a ring arena a consumer can keep frames without copying them: eubx_retain_message
+     * protects the payload from being overwritten until eubx_release_message is called for it
+     * or a later retained frame. Frames that do not fit while payloads are retained are dropped
+     * with EUBX_ERROR_RECEIVE_OVERFLOW.
+     */
+    struct eubx_message_view
+    {
+        uint8_t message_class;
+        uint8_t message_id;
+        uint16_t message_length;
+        const uint8_t *payload;
+        uint32_t timestamp; // host time in microseconds when the frame started, 0 without get_time
+    };
+
+    typedef void (*eubx_notify_message)(void *usr_ptr, const struct eubx_message_view *view);
+    typedef uint32_t (*eubx_get_time)(void *usr_ptr); // monotonic host time in microseconds, may wrap
+    typedef void (*eubx_wait_input)(void *usr_ptr, uint32_t timeout_us); // blocks until input is available or the timeout expired
+
+    // complete sentence from '$' up to and including the line end, not zero terminated
+    typedef void (*eubx_notify_nmea)(void *usr_ptr, const char *sentence, uint16_t length);
+    // complete frame from the 0xd3 preamble up to and including the CRC
+    typedef void (*eubx_notify_rtcm)(void *usr_ptr, const uint8_t *frame, uint16_t length);
+
+    struct eubx_nav_epoch;
+    typedef void (*eubx_notify_epoch)(void *usr_ptr, const struct eubx_nav_epoch *epoch); // once per navigation epoch
+
+    typedef enum
+    {
+        EUBXDirectionRx = 0,
+        EUBXDirectionTx = 1
+    } TEasyUBXDirection;
+
+    // sees every byte exchanged with the receiver, e.g. to record captures
+    typedef bool (*eubx_set_baud)(void *usr_ptr, uint32_t baud_rate); // drains pending output, switches the host port and discards pending input
+
+    typedef void (*eubx_tap)(void *usr_ptr, TEasyUBXDirection direction, const uint8_t *buffer, size_t length);
+
+    struct eubx_tx_segment
+    {
+        const uint8_t *buffer;
+        uint16_t length;
+    };
+
+    typedef void (*eubx_send_vector)(void *usr_ptr, const struct eubx_tx_segment *segments, uint8_t count);
+
+    typedef enum
+    {
+        EUBXPriorityHigh = 0,   // configuration commands
+        EUBXPriorityNormal = 1, // polls
+        EUBXPriorityLow = 2     // bulk data like assistance uploads
+    } TEasyUBXPriority;
+
+    struct eubx_tx_entry
+    {
+        uint32_t offset;
+        uint16_t length;
+        uint8_t priority;
+    };
+
+    typedef enum
+    {
+        EUBXArenaSlab = 0, // every payload is stored at the start of the arena
+        EUBXArenaRing = 1  // payloads are stored one after the other and wrap at the end of the arena
+    } TEasyUBXArenaMode;
+
+    /*
+     * Without fast_resync the parser trusts the length field, a corrupted one makes it skip
+     * everything up to the claimed length before it looks for the next frame. With fast_resync
+     * a length that does not match the message or does not fit the receive storage is rejected
+     * right after the header, and the bytes behind the sync of a rejected frame or of one with a
+     * bad checksum are scanned again, so a bit error costs the damaged frame only.
+     */
+    struct eubx_init_options
+    {
+        uint8_t *receive_arena; // replaces the embedded receive buffer if set
+        uint32_t receive_arena_size;
+        TEasyUBXArenaMode receive_arena_mode;
+        uint8_t *send_arena; // replaces the embedded send buffer if set, needs EUBX_FRAME_OVERHEAD extra bytes
+        uint32_t send_arena_size;
+        uint8_t *tx_queue; // enables eubx_queue_message batching if set
+        uint32_t tx_queue_size;
+        eubx_send_vector send_vector; // writes all queued frames at once, e.g. with writev
+        eubx_notify_message notify_message; // called for every frame with a valid checksum
+        eubx_get_time get_time;     // required for timeouts and round trip tracking
+        eubx_wait_input wait_input; // lets waits sleep instead of polling the transport
+        eubx_notify_nmea notify_nmea; // enables NMEA sentences with a valid checksum
+        eubx_notify_rtcm notify_rtcm; // enables RTCM3 frames with a valid CRC, larger ones need a receive arena
+        bool fast_resync; // rejects implausible lengths and rescans rejected frames for the next sync, see below
+        eubx_tap tap;
+        void *tap_usr_ptr;
+        eubx_set_baud set_baud; // lets init find the baud rate of the receiver, needs get_time
+        uint32_t baud_rate;     // rate the host port is opened with, probed first
+        const uint8_t *warm_state; // from eubx_save_warm_state, replaces the init polls if it is valid
+        uint16_t warm_state_length;
+        bool nonblocking; // init returns at once and eubx_loop runs the bring-up, see below
+        eubx_notify_epoch notify_epoch; // called once per navigation epoch
+    };
+
+    /*
+     * The bring-up finds the baud rate if set_baud is given and polls MON-VER, CFG-NAV5 and
+     * CFG-RATE. A blocking init runs it to the end and returns its result. With nonblocking
+     * set, init only sends the first polls; every step is advanced by the answers and
+     * timeouts eubx_loop handles and reported with the EUBXBringUp events, so one thread
+     * can bring up many receivers at once. Without get_time nothing times out and a silent
+     * receiver stays in its current step.
+     */
+    typedef enum
+    {
+        EUBXBringUpStateIdle,
+        EUBXBringUpStateDetecting, // probing baud rates with CFG-PRT
+        EUBXBringUpStateQuerying,  // receiver info and configuration polls in flight
+        EUBXBringUpStateReady,
+        EUBXBringUpStateFailed
+    } TEasyUBXBringUpState;
+
+    typedef enum
+    {
+        EUBXWarmNone,      // initialized by polling the receiver
+        EUBXWarmVerifying, // the cached state is in use, the check is in flight
+        EUBXWarmVerified,
+        EUBXWarmMismatch
+    } TEasyUBXWarmStatus;
+
+    typedef enum
+    {
+        EUBXRequestPoll, // completed by the response, CFG polls additionally by their ACK
+        EUBXRequestSet   // completed by ACK or NAK
+    } TEasyUBXRequestType;
+
+    typedef void (*eubx_request_done)(void *usr_ptr, uint8_t message_class, uint8_t message_id, TEasyUBXError result);
+
+    struct eubx_request
+    {
+        bool in_use;
+        bool response_received;
+        TEasyUBXRequestType type;
+        uint8_t message_class;
+        uint8_t message_id;
+        uint16_t sequence; // orders requests for the same class and id
+        bool queued;       // still in the TX queue, send_time is stamped when the queue is flushed
+        uint32_t send_time;
+        uint32_t timeout_ms;
+        eubx_request_done done;
+        void *usr_ptr;
+    };
+
+    struct eubx_rtt_entry
+    {
+        uint8_t message_class;
+        uint8_t message_id;
+        uint16_t samples;
+        uint32_t srtt_us;   // smoothed round trip time
+        uint32_t rttvar_us; // round trip time variation
+    };
+
+    struct eubx_stats_message
+    {
+        bool in_use;
+        uint8_t message_class;
+        uint8_t message_id;
+        uint32_t frames;
+    };
+
+    /*
+     * Counters of one handle. They are written by the thread running the parser only and can be
+     * copied out with eubx_get_stats from any thread while it runs. Every counter is read
+     * atomically on its own, a snapshot is not consistent across counters. All counters wrap.
+     */
+    struct eubx_stats
+    {
+        uint32_t bytes_in;
+        uint32_t frames; // UBX frames with a valid checksum
+        uint32_t frames_other; // frames of class/id pairs that did not fit the message table
+        uint32_t nmea_sentences;
+        uint32_t rtcm_frames;
+        uint32_t checksum_errors; // UBX, NMEA and RTCM3
+        uint32_t length_errors;
+        uint32_t overflows;
+        uint32_t resyncs; // rejected frames scanned again with fast_resync
+        uint32_t unknown_classes;
+        uint32_t naks;
+        uint32_t timeouts;
+        uint32_t nav_epochs;
+        uint32_t nav_incomplete_epochs; // closed with an expected message missing
+        uint32_t nav_late_frames;
+        struct eubx_stats_message messages[EUBX_STATS_MESSAGE_TABLE_SIZE];
+        uint32_t callback_latency[EUBX_STATS_HISTOGRAM_BUCKETS]; // first byte of a frame to its dispatch, needs get_time
+        uint32_t rtt[EUBX_STATS_HISTOGRAM_BUCKETS];              // request to response or ACK
     };
 
     typedef enum
@@ -109,6 +442,8 @@ extern "C"
     {
         TEasyUBXChipsetVersion chipset_version;
         char software_version[EUBX_SW_VERSION_LENGTH];
+        uint8_t unique_id[EUBX_UNIQUE_ID_LENGTH]; // chip id from SEC-UNIQID
+        uint8_t unique_id_length;                 // 0 until SEC-UNIQID was received
     };
 
     typedef enum
@@ -132,12 +467,265 @@ extern "C"
         EUBXFixModeAuto2D3D = 3
     } TEasyUBXFixMode;
 
+    // CFG-PRT of the port the host is connected to
+    struct eubx_port_config
+    {
+        uint8_t port_id; // 1 and 2 are UARTs, 0 is I2C, 3 USB and 4 SPI
+        uint16_t tx_ready;
+        uint32_t mode;
+        uint32_t baud_rate; // 0 until CFG-PRT was received
+        uint16_t in_proto_mask;
+        uint16_t out_proto_mask;
+        uint16_t flags;
+    };
+
+    struct eubx_gnss_block
+    {
+        uint8_t gnss_id; // 0 GPS, 1 SBAS, 2 Galileo, 3 BeiDou, 4 IMES, 5 QZSS, 6 GLONASS
+        uint8_t reserved_channels;
+        uint8_t max_channels;
+        uint32_t flags; // bit 0 enables the constellation, bits 16 to 23 select its signals
+    };
+
+    // CFG-GNSS, the constellations the receiver tracks
+    struct eubx_gnss_config
+    {
+        uint8_t hw_channels;
+        uint8_t used_channels;
+        uint8_t block_count; // 0 until CFG-GNSS was received
+        struct eubx_gnss_block blocks[EUBX_GNSS_BLOCK_COUNT];
+    };
+
     struct eubx_receiver_config
     {
         TEasyUBXDynamicPlatformModel dynamic_platform_model;
         TEasyUBXFixMode fix_mode;
         uint16_t measurement_rate;
         uint16_t navigation_rate;
+        uint16_t rate_time_reference; // 0 UTC, 1 GPS, 2 GLONASS, 3 BeiDou, 4 Galileo
+        struct eubx_port_config port;
+        struct eubx_gnss_config gnss;
+    };
+
+    // output rates of one message in navigation solutions, as set by CFG-MSG
+    struct eubx_message_rate
+    {
+        uint8_t message_class;
+        uint8_t message_id;
+        uint8_t rates[EUBX_PORT_COUNT]; // indexed by port id, 0 disables the message on the port
+    };
+
+    /*
+     * Decoded navigation messages. All values are the integers of the UBX payload,
+     * the unit is part of the field name: deg_e7 is degrees * 1e7, deg_e5 degrees * 1e5,
+     * dop_e2 a dilution of precision * 100.
+     */
+    struct eubx_nav_pvt
+    {
+        uint32_t itow_ms; // GPS time of week of the navigation epoch
+        uint16_t year;
+        uint8_t month;
+        uint8_t day;
+        uint8_t hour;
+        uint8_t minute;
+        uint8_t second;
+        uint8_t valid;
+        uint32_t time_accuracy_ns;
+        int32_t nano_ns;
+        uint8_t fix_type;
+        uint8_t flags;
+        uint8_t flags2;
+        uint8_t num_sv;
+        int32_t longitude_deg_e7;
+        int32_t latitude_deg_e7;
+        int32_t height_mm;     // above the ellipsoid
+        int32_t height_msl_mm; // above mean sea level
+        uint32_t horizontal_accuracy_mm;
+        uint32_t vertical_accuracy_mm;
+        int32_t velocity_north_mm_s;
+        int32_t velocity_east_mm_s;
+        int32_t velocity_down_mm_s;
+        int32_t ground_speed_mm_s;
+        int32_t heading_motion_deg_e5;
+        uint32_t speed_accuracy_mm_s;
+        uint32_t heading_accuracy_deg_e5;
+        uint16_t pdop_e2;
+        int32_t heading_vehicle_deg_e5; // 0 for receivers sending the 84 byte version
+    } EUBX_CACHE_ALIGNED;
+
+    struct eubx_nav_posllh
+    {
+        uint32_t itow_ms;
+        int32_t longitude_deg_e7;
+        int32_t latitude_deg_e7;
+        int32_t height_mm;
+        int32_t height_msl_mm;
+        uint32_t horizontal_accuracy_mm;
+        uint32_t vertical_accuracy_mm;
+    } EUBX_CACHE_ALIGNED;
+
+    struct eubx_nav_velned
+    {
+        uint32_t itow_ms;
+        int32_t velocity_north_cm_s;
+        int32_t velocity_east_cm_s;
+        int32_t velocity_down_cm_s;
+        uint32_t speed_cm_s;
+        uint32_t ground_speed_cm_s;
+        int32_t heading_deg_e5;
+        uint32_t speed_accuracy_cm_s;
+        uint32_t heading_accuracy_deg_e5;
+    } EUBX_CACHE_ALIGNED;
+
+    struct eubx_nav_sol
+    {
+        uint32_t itow_ms;
+        int32_t ftow_ns;
+        int16_t week;
+        uint8_t fix_type;
+        uint8_t flags;
+        int32_t ecef_x_cm;
+        int32_t ecef_y_cm;
+        int32_t ecef_z_cm;
+        uint32_t position_accuracy_cm;
+        int32_t ecef_vx_cm_s;
+        int32_t ecef_vy_cm_s;
+        int32_t ecef_vz_cm_s;
+        uint32_t speed_accuracy_cm_s;
+        uint16_t pdop_e2;
+        uint8_t num_sv;
+    } EUBX_CACHE_ALIGNED;
+
+    struct eubx_nav_dop
+    {
+        uint32_t itow_ms;
+        uint16_t gdop_e2;
+        uint16_t pdop_e2;
+        uint16_t tdop_e2;
+        uint16_t vdop_e2;
+        uint16_t hdop_e2;
+        uint16_t ndop_e2;
+        uint16_t edop_e2;
+    } EUBX_CACHE_ALIGNED;
+
+    struct eubx_nav_timeutc
+    {
+        uint32_t itow_ms;
+        uint32_t time_accuracy_ns;
+        int32_t nano_ns;
+        uint16_t year;
+        uint8_t month;
+        uint8_t day;
+        uint8_t hour;
+        uint8_t minute;
+        uint8_t second;
+        uint8_t valid;
+    } EUBX_CACHE_ALIGNED;
+
+    typedef enum
+    {
+        EUBXEpochEnd,      // NAV-EOE
+        EUBXEpochNextITOW, // a NAV message of a later epoch arrived first
+        EUBXEpochTimeout   // no NAV message for EUBX_NAV_EPOCH_TIMEOUT_MS, receivers without NAV-EOE only
+    } TEasyUBXEpochClose;
+
+    /*
+     * The navigation messages of one epoch, grouped by iTOW. An epoch is closed by NAV-EOE;
+     * receivers that never sent NAV-EOE (u-blox 7 and older) close it on the next iTOW or
+     * after EUBX_NAV_EPOCH_TIMEOUT_MS without NAV messages, the timeout needs get_time and
+     * eubx_loop. Members whose bit is missing in messages were not sent for this epoch and
+     * hold the one of an earlier epoch. iTOWs are compared within the week, so the epochs
+     * after the end of a week follow the last one before it.
+     *
+     * expected holds the messages of the recent epochs, a message missing in two epochs in a
+     * row is taken as disabled. Frames of an epoch already closed are decoded into the handle
+     * as usual but counted as late and kept out of the epochs. An iTOW more than
+     * EUBX_NAV_EPOCH_LATE_MS before the last epoch starts a new one instead.
+     *
+     * The closed epoch goes to notify_epoch and is published for other threads: two copies
+     * are kept behind a sequence counter, the parser writes one while readers copy the other.
+     * eubx_read_nav_snapshot never waits for the parser and never takes a lock, it only
+     * repeats the copy if an epoch was published meanwhile.
+     */
+    struct eubx_nav_epoch
+    {
+        uint32_t number;  // epochs closed since init, 0 before the first
+        uint32_t itow_ms;
+        TEasyUBXEpochClose closed_by;
+        uint8_t messages; // EUBX_NAV_MESSAGE_* bits received for this epoch
+        uint8_t expected;
+        uint8_t dropped;  // expected messages that did not arrive
+        uint16_t late;    // frames of closed epochs since the previous one
+        struct eubx_nav_pvt pvt;
+        struct eubx_nav_posllh posllh;
+        struct eubx_nav_velned velned;
+        struct eubx_nav_sol sol;
+        struct eubx_nav_dop dop;
+        struct eubx_nav_timeutc timeutc;
+    };
+
+    /*
+     * Receiver side port statistics merged from MON-IO, MON-RXBUF, MON-TXBUF and MON-MSGPP.
+     * Counts are totals since the receiver started, usages percent of the buffer. A TX peak
+     * near 100 or a set tx_errors bit means the message plan exceeds the bandwidth of the port.
+     */
+    struct eubx_mon_port
+    {
+        uint32_t rx_bytes;
+        uint32_t tx_bytes;
+        uint16_t parity_errors;
+        uint16_t framing_errors;
+        uint16_t overrun_errors;
+        uint16_t break_conditions;
+        uint16_t rx_pending;
+        uint8_t rx_usage_percent;
+        uint8_t rx_peak_usage_percent;
+        uint16_t tx_pending;
+        uint8_t tx_usage_percent;
+        uint8_t tx_peak_usage_percent;
+        uint16_t messages[EUBX_MON_PROTOCOL_COUNT]; // parsed messages per protocol
+        uint32_t skipped_bytes;
+    };
+
+    struct eubx_mon_ports
+    {
+        struct eubx_mon_port ports[EUBX_MON_PORT_COUNT];
+        uint8_t port_count; // ports reported by MON-IO
+        uint8_t tx_usage_percent; // all ports together
+        uint8_t tx_peak_usage_percent;
+        uint8_t tx_errors; // bits 0-5 buffer limit of the port reached, bit 6 memory and bit 7 allocation error
+    };
+
+    struct eubx_mon_hw
+    {
+        uint16_t noise_per_ms;
+        uint16_t agc_count; // 0 to 8191
+        uint8_t antenna_status;
+        uint8_t antenna_power;
+        uint8_t flags;
+        uint8_t jamming_state;     // 0 unknown or disabled, 1 ok, 2 warning, 3 critical
+        uint8_t jamming_indicator; // continuous wave jamming, 0 none to 255 strong
+    };
+
+    struct eubx_poll_entry
+    {
+        uint8_t message_class;
+        uint8_t message_id;
+        uint32_t interval_ms; // 0 marks a free entry
+        uint32_t next_time;   // host time of the next poll
+    };
+
+    struct eubx_handle;
+
+    typedef void (*eubx_message_handler)(void *usr_ptr, struct eubx_handle *pHandle, const struct eubx_message_view *view);
+
+    struct eubx_user_handler
+    {
+        bool in_use;
+        uint8_t message_class;
+        uint8_t message_id;
+        eubx_message_handler handler;
+        void *usr_ptr;
     };
 
     typedef uint16_t (*eubx_receive_buffer)(void *usr_ptr, uint8_t *buffer, uint16_t max_length);
@@ -150,39 +738,186 @@ extern "C"
         bool is_initialized;      // is set to true if handle is initialized
         TEasyUBXError last_error; // last error code, will be OK if an operation was successful
         TEasyUBXReceiveStatus receive_status;
+        TEasyUBXError receive_error; // of the frame being received, only an overflow or a bad length drops it
         struct eubx_message receive_message;
+        uint8_t *receive_arena;
+        uint32_t receive_arena_size;
+        uint32_t receive_arena_head; // offset of the next payload in ring mode
+        uint32_t receive_arena_tail;       // offset of the oldest retained payload in ring mode
+        uint32_t receive_arena_retain_end; // end offset of the newest retained payload
+        bool receive_arena_retained;
+        bool receive_arena_wrapped;         // the head is behind the tail, retained payloads run up to wrap_end
+        uint32_t receive_arena_wrap_end;    // where the head last wrapped to the start of the arena
+        uint32_t receive_time;      // host time of the chunk being parsed
+        uint32_t receive_timestamp; // host time the current frame started
+        TEasyUBXArenaMode receive_arena_mode;
         uint16_t receive_position;
+        uint8_t receive_ck_a; // running checksum of the frame being received
+        uint8_t receive_ck_b;
+        bool fast_resync;
+        bool receive_rescanning; // a rejected frame is scanned again
         TEasyUBXEvent last_event;
+        uint8_t ack_class; // class of the message the last ACK/NAK refers to
+        uint8_t ack_id;    // id of the message the last ACK/NAK refers to
+        uint8_t send_class; // class of the last message sent
+        uint8_t send_id;
+        uint32_t send_time; // host time the last message was sent
+        struct eubx_rtt_entry rtt_table[EUBX_RTT_TABLE_SIZE];
+        uint8_t rtt_next;
+        struct eubx_user_handler user_handlers[EUBX_USER_HANDLER_TABLE_SIZE];
+        eubx_message_handler default_handler; // frames without built in or registered handler
+        void *default_handler_usr_ptr;
+        struct eubx_request requests[EUBX_MAX_PENDING_REQUESTS];
+        uint8_t pending_requests;
+        uint16_t request_sequence;
+        struct eubx_poll_entry poll_schedule[EUBX_POLL_SCHEDULE_SIZE];
+        const struct eubx_message_rate *message_plan; // plan being applied, CFG-MSG answers are compared with it
+        uint8_t message_plan_count;
+        uint32_t message_plan_matched; // bit per plan entry the receiver reported with the planned rates
+        TEasyUBXError request_error; // first failure since the last eubx_waitfor_requests
         struct eubx_message send_message;
+        uint8_t *tx_queue;
+        uint32_t tx_queue_size;
+        uint32_t tx_queue_used;
+        struct eubx_tx_entry tx_queue_entries[EUBX_TX_QUEUE_DEPTH];
+        uint8_t tx_queue_count;
         eubx_receive_buffer receive_buffer;
         eubx_send_byte send_byte;
         eubx_send_buffer send_buffer;
         eubx_notify_event notify_event;
+        eubx_notify_message notify_message;
+        eubx_get_time get_time;
+        eubx_wait_input wait_input;
+        eubx_send_vector send_vector;
+        eubx_notify_nmea notify_nmea;
+        eubx_notify_rtcm notify_rtcm;
+        eubx_tap tap;
+        void *tap_usr_ptr;
+        eubx_set_baud set_baud;
+        uint32_t baud_rate; // host side of the link, 0 if unknown
         void *callback_usr_ptr;
         struct eubx_receiver_info receiver_info;
         struct eubx_receiver_config receiver_config;
+        TEasyUBXWarmStatus warm_status;
+        struct eubx_receiver_info warm_key; // identity the cached state was saved for
+        uint8_t warm_pending;               // verification polls still in flight
+        TEasyUBXBringUpState bringup_state;
+        TEasyUBXError bringup_error;   // first failure of the current step
+        uint32_t bringup_initial_baud; // probed first and without a switch
+        uint8_t bringup_candidate;     // next of the common baud rates
+        uint8_t bringup_attempt;       // probes sent at the current rate
+        uint8_t bringup_pending;       // bring-up polls still in flight
+        struct eubx_nav_pvt nav_pvt;
+        struct eubx_nav_posllh nav_posllh;
+        struct eubx_nav_velned nav_velned;
+        struct eubx_nav_sol nav_sol;
+        struct eubx_nav_dop nav_dop;
+        struct eubx_nav_timeutc nav_timeutc;
+        struct eubx_mon_ports mon_ports;
+        struct eubx_mon_hw mon_hw;
+#if EUBX_NAV_EPOCH_ENABLED
+        eubx_notify_epoch notify_epoch;
+        uint32_t nav_epoch_itow_ms; // epoch being assembled
+        uint32_t nav_epoch_time;    // host time of its last frame
+        uint8_t nav_epoch_messages;
+        uint8_t nav_epoch_expected;
+        uint8_t nav_epoch_missing; // expected messages the last closed epoch lacked
+        uint16_t nav_epoch_late;
+        bool nav_eoe_seen;
+        struct eubx_nav_epoch nav_epoch; // the last one closed, merges the frames of the next
+#endif
+#if EUBX_NAV_SNAPSHOT_ENABLED
+        uint32_t nav_sequence EUBX_CACHE_ALIGNED; // odd while nav_snapshots[0] is written, even while [1] is
+        struct eubx_nav_epoch nav_snapshots[2];
+#endif
+#if EUBX_STATS_ENABLED
+        struct eubx_stats stats;
+#endif
+#if EUBX_MESSAGE_BUFFER_SIZE > 0
+        uint8_t receive_storage[EUBX_MESSAGE_BUFFER_SIZE];
+        uint8_t send_storage[EUBX_MESSAGE_BUFFER_SIZE + EUBX_FRAME_OVERHEAD];
+#endif
     };
 
     TEasyUBXError eubx_init(struct eubx_handle *pHandle, eubx_receive_buffer receive_buffer, eubx_send_byte send_byte, eubx_send_buffer send_buffer, eubx_notify_event notify_event, void *usr_ptr);
+    TEasyUBXError eubx_init_ex(struct eubx_handle *pHandle, eubx_receive_buffer receive_buffer, eubx_send_byte send_byte, eubx_send_buffer send_buffer, eubx_notify_event notify_event, void *usr_ptr, const struct eubx_init_options *options);
     TEasyUBXError eubx_receive_byte(struct eubx_handle *pHandle, uint8_t byte);
+    TEasyUBXError eubx_receive_bytes(struct eubx_handle *pHandle, const uint8_t *buffer, size_t length);
     void eubx_loop(struct eubx_handle *pHandle);
 
+    /*
+     * For event loops that read the transport themselves and pass the bytes to
+     * eubx_receive_bytes: scheduled polls, request timeouts and the epoch timeout only run in
+     * eubx_loop or eubx_run_timers, the loop has to wake up for them after the time returned
+     * by eubx_time_to_deadline even if no data arrives. Both need get_time.
+     */
+    uint32_t eubx_time_to_deadline(struct eubx_handle *pHandle); // ms, EUBX_NO_DEADLINE if nothing is due
+    void eubx_run_timers(struct eubx_handle *pHandle);            // eubx_loop without reading the transport
+
     TEasyUBXError eubx_set_dyn_model(struct eubx_handle *pHandle, TEasyUBXDynamicPlatformModel dyn_model, TEasyUBXFixMode fix_mode);
 
     TEasyUBXError eubx_waitfor_event(struct eubx_handle *pHandle, TEasyUBXEvent event);
+    TEasyUBXError eubx_waitfor_event_timeout(struct eubx_handle *pHandle, TEasyUBXEvent event, uint32_t timeout_ms);
     TEasyUBXError eubx_waitfor_ack(struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id);
+    TEasyUBXError eubx_waitfor_ack_timeout(struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id, uint32_t timeout_ms);
+
+    uint32_t eubx_get_timeout(const struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id);
+    void eubx_record_rtt(struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id, uint32_t rtt_us);
 
     TEasyUBXError eubx_poll_cfg_nav5(struct eubx_handle *pHandle);
     TEasyUBXError eubx_poll_cfg_port(struct eubx_handle *pHandle);
     TEasyUBXError eubx_poll_cfg_rate(struct eubx_handle *pHandle);
+    TEasyUBXError eubx_poll_cfg_gnss(struct eubx_handle *pHandle);
+    uint16_t eubx_get_min_measurement_rate(const struct eubx_handle *pHandle, bool single_gnss); // fastest measurement period in ms of the chipset
+    TEasyUBXError eubx_set_measurement_rate(struct eubx_handle *pHandle, uint16_t measurement_rate_ms, uint16_t navigation_rate, uint16_t time_reference);
+    TEasyUBXError eubx_set_high_rate(struct eubx_handle *pHandle, uint16_t measurement_rate_ms, struct eubx_message_rate *plan, uint8_t count); // thins the plan to fit the link
+    TEasyUBXError eubx_apply_message_plan(struct eubx_handle *pHandle, const struct eubx_message_rate *plan, uint8_t count); // skips entries that already match
+    TEasyUBXError eubx_disable_default_nmea(struct eubx_handle *pHandle); // GGA, GLL, GSA, GSV, RMC and VTG on all ports
+    TEasyUBXError eubx_set_cfg_port(struct eubx_handle *pHandle, const struct eubx_port_config *port); // not acknowledged if the baud rate changes
+
+    TEasyUBXError eubx_detect_baud(struct eubx_handle *pHandle, const uint32_t *candidates, uint8_t count); // NULL tries the common rates
+    TEasyUBXError eubx_upgrade_baud(struct eubx_handle *pHandle, const uint32_t *candidates, uint8_t count); // rates the host supports, NULL for the common ones
+    uint32_t eubx_message_plan_load(const struct eubx_message_rate *plan, uint8_t count, uint8_t port_id, uint16_t measurement_rate_ms, uint16_t navigation_rate); // bytes per second
+    TEasyUBXError eubx_check_message_plan(const struct eubx_handle *pHandle, const struct eubx_message_rate *plan, uint8_t count);
 
     TEasyUBXError eubx_poll_mon_gnss_selection(struct eubx_handle *pHandle);
     TEasyUBXError eubx_poll_mon_version(struct eubx_handle *pHandle);
+    TEasyUBXError eubx_schedule_mon_telemetry(struct eubx_handle *pHandle, uint32_t interval_ms); // MON-IO, RXBUF, TXBUF, MSGPP and HW, 0 stops
+
+    TEasyUBXError eubx_poll_sec_uniqid(struct eubx_handle *pHandle);
+
+    uint16_t eubx_save_warm_state(const struct eubx_handle *pHandle, uint8_t *buffer, uint16_t size); // 0 if the identity is not known yet
+
+    TEasyUBXError eubx_start_bringup(struct eubx_handle *pHandle); // restarts a failed or finished bring-up without waiting
+    TEasyUBXBringUpState eubx_bringup_state(const struct eubx_handle *pHandle);
 
     TEasyUBXError eubx_send_message(struct eubx_handle *pHandle);
+    TEasyUBXError eubx_send_frame(struct eubx_handle *pHandle, const uint8_t *frame, uint16_t length); // complete frame including sync and checksum
+    TEasyUBXError eubx_queue_message(struct eubx_handle *pHandle, TEasyUBXPriority priority);
+    void eubx_flush_queue(struct eubx_handle *pHandle);
     TEasyUBXError eubx_send_message_wait4ack(struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id);
+
+    TEasyUBXError eubx_send_request(struct eubx_handle *pHandle, TEasyUBXRequestType type, eubx_request_done done, void *usr_ptr);
+    TEasyUBXError eubx_request_poll(struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id, eubx_request_done done, void *usr_ptr);
+    uint8_t eubx_pending_requests(const struct eubx_handle *pHandle);
+    TEasyUBXError eubx_schedule_poll(struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id, uint32_t interval_ms); // 0 stops, needs get_time
+    TEasyUBXError eubx_waitfor_requests(struct eubx_handle *pHandle);
     TEasyUBXError eubx_send_notification(struct eubx_handle *pHandle, TEasyUBXEvent event);
 
+    TEasyUBXError eubx_retain_message(struct eubx_handle *pHandle, const struct eubx_message_view *view);
+    TEasyUBXError eubx_release_message(struct eubx_handle *pHandle, const struct eubx_message_view *view);
+
+    uint32_t eubx_read_nav_snapshot(const struct eubx_handle *pHandle, struct eubx_nav_epoch *epoch); // epoch number, safe from any thread
+
+    void eubx_get_stats(const struct eubx_handle *pHandle, struct eubx_stats *stats);
+    uint32_t eubx_stats_percentile(const uint32_t *histogram, uint8_t percent); // upper bound of the bucket in us
+
+    TEasyUBXError eubx_register_handler(struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id, eubx_message_handler handler, void *usr_ptr);
+    void eubx_set_default_handler(struct eubx_handle *pHandle, eubx_message_handler handler, void *usr_ptr);
+
+    void eubx_checksum_update(uint8_t *ck_a, uint8_t *ck_b, const uint8_t *buffer, size_t length);
+    uint32_t eubx_crc24q_update(uint32_t crc, const uint8_t *buffer, size_t length);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -0,0 +1,260 @@
+/*
+ * source file for the Easy UBX C library for the receiver bring-up
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "easyubx_drv.h"
+#include "easyubx_drv_bringup.h"
+#include "easyubx_drv_consts.h"
+#include "easyubx_drv_link.h"
+#include "easyubx_drv_request.h"
+
+static TEasyUBXError send_probe(struct eubx_handle *pHandle);
+static TEasyUBXError send_queries(struct eubx_handle *pHandle);
+static void bringup_request_done(void *usr_ptr, uint8_t message_class, uint8_t message_id, TEasyUBXError result);
+static void enter_state(struct eubx_handle *pHandle, TEasyUBXBringUpState state, TEasyUBXError result);
+
+/*
+ * Every step sends its polls with bringup_request_done as callback and returns, the
+ * callback sends the polls of the next step. Answers and timeouts are handled by
+ * eubx_loop, so the machine needs nothing else to advance.
+ */
+TEasyUBXError eubx_start_bringup(struct eubx_handle *pHandle)
+{
+    TEasyUBXError rc = EUBX_ERROR_NULLPTR;
+
+    if (NULL != pHandle)
+    {
+        rc = pHandle->is_initialized ? EUBX_ERROR_OK : EUBX_ERROR_NOT_INITIALIZED;
+    }
+
+    // answers to an earlier run would be taken for answers to this one
+    if ((EUBX_ERROR_OK == rc) && (0 < pHandle->bringup_pending))
+    {
+        rc = EUBX_ERROR_BUSY;
+    }
+
+    // a wrong rate never answers, without a clock the probe would wait forever
+    if ((EUBX_ERROR_OK == rc) && (NULL != pHandle->set_baud) && (NULL == pHandle->get_time))
+    {
+        rc = EUBX_ERROR_NOT_SUPPORTED;
+        pHandle->last_error = rc;
+    }
+
+    if (EUBX_ERROR_OK == rc)
+    {
+        pHandle->bringup_error = EUBX_ERROR_OK;
+        pHandle->bringup_initial_baud = pHandle->baud_rate;
+        pHandle->bringup_candidate = 0;
+
+        // the rate the port is open with costs no switch and is right most of the time
+        pHandle->bringup_attempt = (0 != pHandle->baud_rate) ? 0 : EUBX_LINK_PROBE_ATTEMPTS;
+
+        if (NULL != pHandle->set_baud)
+        {
+            enter_state(pHandle, EUBXBringUpStateDetecting, EUBX_ERROR_OK);
+            rc = send_probe(pHandle);
+        }
+        else
+        {
+            enter_state(pHandle, EUBXBringUpStateQuerying, EUBX_ERROR_OK);
+            rc = send_queries(pHandle);
+        }
+
+        if (EUBX_ERROR_OK != rc)
+        {
+            enter_state(pHandle, EUBXBringUpStateFailed, rc);
+        }
+    }
+
+    return rc;
+}
+
+TEasyUBXBringUpState eubx_bringup_state(const struct eubx_handle *pHandle)
+{
+    return pHandle->bringup_state;
+}
+
+void eubx_drv_bringup_reset(struct eubx_handle *pHandle)
+{
+    pHandle->bringup_state = EUBXBringUpStateIdle;
+    pHandle->bringup_error = EUBX_ERROR_OK;
+    pHandle->bringup_initial_baud = 0;
+    pHandle->bringup_candidate = 0;
+    pHandle->bringup_attempt = 0;
+    pHandle->bringup_pending = 0;
+}
+
+TEasyUBXError eubx_drv_bringup_run(struct eubx_handle *pHandle)
+{
+    TEasyUBXError rc = eubx_start_bringup(pHandle);
+
+    // the callbacks send the next polls before the last one is done, so this covers all steps
+    if (EUBX_ERROR_OK == rc)
+    {
+        eubx_waitfor_requests(pHandle);
+
+        // the overall limit of the wait dropped the requests
+        if ((EUBXBringUpStateReady != pHandle->bringup_state) && (EUBXBringUpStateFailed != pHandle->bringup_state))
+        {
+            pHandle->bringup_pending = 0;
+            enter_state(pHandle, EUBXBringUpStateFailed, EUBX_ERROR_TIMEOUT);
+        }
+
+        rc = (EUBXBringUpStateReady == pHandle->bringup_state) ? EUBX_ERROR_OK : pHandle->bringup_error;
+    }
+
+    return rc;
+}
+
+/*
+ * Probes the current rate until its attempts are used up, then switches to the next
+ * common rate the host supports. TIMEOUT once all of them were tried.
+ */
+TEasyUBXError send_probe(struct eubx_handle *pHandle)
+{
+    TEasyUBXError rc = EUBX_ERROR_OK;
+
+    while (EUBX_LINK_PROBE_ATTEMPTS <= pHandle->bringup_attempt)
+    {
+        uint32_t baud_rate = eubx_drv_link_common_rate(pHandle->bringup_candidate);
+
+        if (0 == baud_rate)
+        {
+            rc = EUBX_ERROR_TIMEOUT;
+            break;
+        }
+
+        pHandle->bringup_candidate++;
+
+        if ((baud_rate != pHandle->bringup_initial_baud) && pHandle->set_baud(pHandle->callback_usr_ptr, baud_rate))
+        {
+            // a frame cut by the switch would swallow the first bytes at the new rate
+            pHandle->receive_status = EUBXReceiveExpectSync1;
+            pHandle->baud_rate = baud_rate;
+            pHandle->bringup_attempt = 0;
+        }
+    }
+
+    if (EUBX_ERROR_OK == rc)
+    {
+        rc = eubx_drv_request_poll_within(pHandle, EUBX_CLASS_CFG, EUBX_ID_CFG_PRT, eubx_drv_link_probe_timeout(pHandle->baud_rate), bringup_request_done, pHandle);
+    }
+
+    if (EUBX_ERROR_OK == rc)
+    {
+        pHandle->bringup_attempt++;
+        pHandle->bringup_pending++;
+    }
+
+    return rc;
+}
+
+// the three polls are in flight together and answered in order
+TEasyUBXError send_queries(struct eubx_handle *pHandle)
+{
+    static const uint8_t queries[][2] = {{EUBX_CLASS_MON, EUBX_ID_MON_VER}, {EUBX_CLASS_CFG, EUBX_ID_CFG_NAV5}, {EUBX_CLASS_CFG, EUBX_ID_CFG_RATE}};
+    TEasyUBXError rc = EUBX_ERROR_OK;
+
+    for (uint8_t i = 0; (EUBX_ERROR_OK == rc) && (i < sizeof(queries) / sizeof(queries[0])); i++)
+    {
+        rc = eubx_request_poll(pHandle, queries[i][0], queries[i][1], bringup_request_done, pHandle);
+
+        if (EUBX_ERROR_OK == rc)
+        {
+            pHandle->bringup_pending++;
+        }
+    }
+
+    return rc;
+}
+
+void bringup_request_done(void *usr_ptr, uint8_t message_class, uint8_t message_id, TEasyUBXError result)
+{
+    struct eubx_handle *pHandle = (struct eubx_handle *)usr_ptr;
+    TEasyUBXError rc = EUBX_ERROR_OK;
+
+    pHandle->bringup_pending--;
+
+    if (EUBXBringUpStateDetecting == pHandle->bringup_state)
+    {
+        if (EUBX_ERROR_OK == result)
+        {
+            enter_state(pHandle, EUBXBringUpStateQuerying, EUBX_ERROR_OK);
+            rc = send_queries(pHandle);
+        }
+        else
+        {
+            rc = send_probe(pHandle);
+        }
+    }
+    else if (EUBXBringUpStateQuerying == pHandle->bringup_state)
+    {
+        if ((EUBX_ERROR_OK != result) && (EUBX_ERROR_OK == pHandle->bringup_error))
+        {
+            pHandle->bringup_error = result;
+        }
+
+        if (0 == pHandle->bringup_pending)
+        {
+            rc = pHandle->bringup_error;
+
+            if (EUBX_ERROR_OK == rc)
+            {
+                enter_state(pHandle, EUBXBringUpStateReady, EUBX_ERROR_OK);
+            }
+        }
+    }
+
+    // polls of a failed step still in flight end up here as well and change nothing
+    if (EUBX_ERROR_OK != rc)
+    {
+        enter_state(pHandle, EUBXBringUpStateFailed, rc);
+    }
+}
+
+void enter_state(struct eubx_handle *pHandle, TEasyUBXBringUpState state, TEasyUBXError result)
+{
+    TEasyUBXEvent event = EUBXBringUpProgress;
+
+    pHandle->bringup_state = state;
+    pHandle->bringup_error = result;
+
+    if (EUBXBringUpStateReady == state)
+    {
+        // the probes at wrong rates timed out on purpose, a later eubx_waitfor_requests must not report them
+        pHandle->request_error = EUBX_ERROR_OK;
+        pHandle->last_error = EUBX_ERROR_OK;
+        event = EUBXBringUpReady;
+    }
+    else if (EUBXBringUpStateFailed == state)
+    {
+        pHandle->last_error = result;
+        event = EUBXBringUpFailed;
+    }
+
+    eubx_send_notification(pHandle, event);
+}
@@ -31,14 +31,74 @@
 #include "easyubx_drv.h"
 #include "easyubx_drv_consts.h"
 #include "easyubx_drv_cfg.h"
+#include "easyubx_drv_link.h"
+#include "easyubx_drv_util.h"
 
-static void handle_receive_cfg_ant(struct eubx_handle *pHandle);
+#define EUBX_RATE_UNKNOWN_CHIPSET_MS 1000 // receivers without a table entry stay at 1 Hz
+
+// fastest measurement periods, concurrent constellations share the tracking engine
+struct eubx_rate_limits
+{
+    TEasyUBXChipsetVersion chipset_version;
+    uint16_t single_gnss_ms;
+    uint16_t multi_gnss_ms;
+};
+
+static void handle_receive_cfg_gnss(struct eubx_handle *pHandle);
 static void handle_receive_cfg_msg(struct eubx_handle *pHandle);
 static void handle_receive_cfg_nav5(struct eubx_handle *pHandle);
 static void handle_receive_cfg_nmea(struct eubx_handle *pHandle);
 static void handle_receive_cfg_prt(struct eubx_handle *pHandle);
 static void handle_receive_cfg_rate(struct eubx_handle *pHandle);
 
+static const struct eubx_rate_limits *find_rate_limits(const struct eubx_handle *pHandle);
+static uint8_t count_constellations(const struct eubx_gnss_config *gnss);
+static TEasyUBXError restrict_to_gps(struct eubx_handle *pHandle);
+static TEasyUBXError fit_message_plan(struct eubx_handle *pHandle, struct eubx_message_rate *plan, uint8_t count, uint16_t measurement_rate_ms);
+static TEasyUBXError send_plan_requests(struct eubx_handle *pHandle, TEasyUBXRequestType type);
+static void prepare_plan_message(struct eubx_handle *pHandle, const struct eubx_message_rate *entry, TEasyUBXRequestType type);
+
+static const eubx_drv_handler cfg_handlers[] = {
+    [EUBX_ID_CFG_GNSS] = handle_receive_cfg_gnss,
+    [EUBX_ID_CFG_MSG] = handle_receive_cfg_msg,
+    [EUBX_ID_CFG_NAV5] = handle_receive_cfg_nav5,
+    [EUBX_ID_CFG_NMEA] = handle_receive_cfg_nmea,
+    [EUBX_ID_CFG_PRT] = handle_receive_cfg_prt,
+    [EUBX_ID_CFG_RATE] = handle_receive_cfg_rate,
+};
+
+// CFG-NMEA differs between protocol versions and is not checked
+static const struct eubx_drv_length cfg_lengths[] = {
+    [EUBX_ID_CFG_GNSS] = {EUBX_LENGTH_CFG_GNSS_HEADER, EUBX_LENGTH_CFG_GNSS_HEADER + EUBX_GNSS_BLOCK_COUNT * EUBX_LENGTH_CFG_GNSS_BLOCK},
+    [EUBX_ID_CFG_MSG] = {EUBX_LENGTH_CFG_MSG, EUBX_LENGTH_CFG_MSG},
+    [EUBX_ID_CFG_NAV5] = {EUBX_LENGTH_CFG_NAV5, EUBX_LENGTH_CFG_NAV5},
+    [EUBX_ID_CFG_PRT] = {EUBX_LENGTH_CFG_PRT, EUBX_LENGTH_CFG_PRT},
+    [EUBX_ID_CFG_RATE] = {EUBX_LENGTH_CFG_RATE, EUBX_LENGTH_CFG_RATE},
+};
+
+const struct eubx_drv_dispatch eubx_drv_cfg_dispatch = EUBX_DRV_DISPATCH_CHECKED(cfg_handlers, cfg_lengths);
+
+static const struct eubx_rate_limits rate_limits[] = {
+    {EUBXChipsetAntaris, 250, 250},
+    {EUBXChipsetAntaris4, 250, 250},
+    {EUBXChipsetUblox5, 250, 250},
+    {EUBXChipsetUblox6_1, 200, 200},
+    {EUBXChipsetUblox6_2, 200, 200},
+    {EUBXChipsetUblox7, 100, 100},
+    {EUBXChipsetUblox8, 55, 100},
+    {EUBXChipsetUblox9, 40, 40},
+};
+
+// the sentences a receiver outputs in its factory configuration
+static const struct eubx_message_rate default_nmea_off[] = {
+    {EUBX_CLASS_NMEA, EUBX_ID_NMEA_GGA, {0}},
+    {EUBX_CLASS_NMEA, EUBX_ID_NMEA_GLL, {0}},
+    {EUBX_CLASS_NMEA, EUBX_ID_NMEA_GSA, {0}},
+    {EUBX_CLASS_NMEA, EUBX_ID_NMEA_GSV, {0}},
+    {EUBX_CLASS_NMEA, EUBX_ID_NMEA_RMC, {0}},
+    {EUBX_CLASS_NMEA, EUBX_ID_NMEA_VTG, {0}},
+};
+
 TEasyUBXError eubx_poll_cfg_nav5(struct eubx_handle *pHandle)
 {
     pHandle->send_message.message_class = EUBX_CLASS_CFG;
@@ -57,6 +117,100 @@ TEasyUBXError eubx_poll_cfg_port(struct eubx_handle *pHandle)
     return eubx_send_message_wait4ack(pHandle, EUBX_CLASS_CFG, EUBX_ID_CFG_PRT);
 }
 
+/*
+ * Reads back the rates of all entries, sets the ones that differ and reads those back
+ * again. Each step is a pipelined batch, so a plan costs about three round trips instead
+ * of one per entry. Entries the receiver does not know are NAKed while the others are
+ * still applied, the result is the first error or a NAK for rates that did not stick.
+ */
+TEasyUBXError eubx_apply_message_plan(struct eubx_handle *pHandle, const struct eubx_message_rate *plan, uint8_t count)
+{
+    TEasyUBXError rc = EUBX_ERROR_NULLPTR;
+    uint32_t all = 0;
+
+    if ((NULL != pHandle) && ((NULL != plan) || (0 == count)))
+    {
+        rc = (EUBX_MESSAGE_PLAN_SIZE >= count) ? EUBX_ERROR_OK : EUBX_ERROR_LENGTH;
+    }
+
+    if (EUBX_ERROR_OK == rc)
+    {
+        // the shift only after the size check, count is at most EUBX_MESSAGE_PLAN_SIZE here
+        all = (uint32_t)(((uint64_t)1 << count) - 1);
+        pHandle->message_plan = plan;
+        pHandle->message_plan_count = count;
+        pHandle->message_plan_matched = 0;
+
+        // a failed read back only costs a set that was not needed
+        send_plan_requests(pHandle, EUBXRequestPoll);
+
+        if (all != pHandle->message_plan_matched)
+        {
+            TEasyUBXError result = send_plan_requests(pHandle, EUBXRequestSet);
+
+            rc = send_plan_requests(pHandle, EUBXRequestPoll);
+            rc = (EUBX_ERROR_OK == result) ? rc : result;
+        }
+
+        if ((EUBX_ERROR_OK == rc) && (all != pHandle->message_plan_matched))
+        {
+            rc = EUBX_ERROR_NAK;
+        }
+
+        pHandle->message_plan = NULL;
+        pHandle->message_plan_count = 0;
+    }
+
+    if ((NULL != pHandle) && (EUBX_ERROR_OK != rc))
+    {
+        pHandle->last_error = rc;
+    }
+
+    return rc;
+}
+
+TEasyUBXError eubx_disable_default_nmea(struct eubx_handle *pHandle)
+{
+    return eubx_apply_message_plan(pHandle, default_nmea_off, sizeof(default_nmea_off) / sizeof(default_nmea_off[0]));
+}
+
+TEasyUBXError eubx_set_cfg_port(struct eubx_handle *pHandle, const struct eubx_port_config *port)
+{
+    TEasyUBXError rc = EUBX_ERROR_OK;
+    uint8_t *payload = pHandle->send_message.message_buffer;
+
+    pHandle->send_message.message_class = EUBX_CLASS_CFG;
+    pHandle->send_message.message_id = EUBX_ID_CFG_PRT;
+    pHandle->send_message.message_length = EUBX_LENGTH_CFG_PRT;
+
+    memset(payload, 0, EUBX_LENGTH_CFG_PRT);
+
+    payload[0] = port->port_id;
+    eubx_drv_store_u16(&payload[2], port->tx_ready);
+    eubx_drv_store_u32(&payload[4], port->mode);
+    eubx_drv_store_u32(&payload[8], port->baud_rate);
+    eubx_drv_store_u16(&payload[12], port->in_proto_mask);
+    eubx_drv_store_u16(&payload[14], port->out_proto_mask);
+    eubx_drv_store_u16(&payload[16], port->flags);
+
+    // the receiver switches before its ACK is out, so a new baud rate is verified by the caller instead
+    if (port->baud_rate != pHandle->receiver_config.port.baud_rate)
+    {
+        rc = eubx_send_message(pHandle);
+    }
+    else
+    {
+        rc = eubx_send_message_wait4ack(pHandle, EUBX_CLASS_CFG, EUBX_ID_CFG_PRT);
+    }
+
+    if (EUBX_ERROR_OK == rc)
+    {
+        pHandle->receiver_config.port = *port;
+    }
+
+    return rc;
+}
+
 TEasyUBXError eubx_poll_cfg_rate(struct eubx_handle *pHandle)
 {
     pHandle->send_message.message_class = EUBX_CLASS_CFG;
@@ -66,6 +220,113 @@ TEasyUBXError eubx_poll_cfg_rate(struct eubx_handle *pHandle)
     return eubx_send_message_wait4ack(pHandle, EUBX_CLASS_CFG, EUBX_ID_CFG_RATE);
 }
 
+TEasyUBXError eubx_poll_cfg_gnss(struct eubx_handle *pHandle)
+{
+    pHandle->send_message.message_class = EUBX_CLASS_CFG;
+    pHandle->send_message.message_id = EUBX_ID_CFG_GNSS;
+    pHandle->send_message.message_length = 0;
+
+    return eubx_send_message_wait4ack(pHandle, EUBX_CLASS_CFG, EUBX_ID_CFG_GNSS);
+}
+
+uint16_t eubx_get_min_measurement_rate(const struct eubx_handle *pHandle, bool single_gnss)
+{
+    const struct eubx_rate_limits *limits = find_rate_limits(pHandle);
+    uint16_t measurement_rate_ms = EUBX_RATE_UNKNOWN_CHIPSET_MS;
+
+    if (NULL != limits)
+    {
+        measurement_rate_ms = single_gnss ? limits->single_gnss_ms : limits->multi_gnss_ms;
+    }
+
+    return measurement_rate_ms;
+}
+
+/*
+ * Rates only a single constellation reaches are refused while CFG-GNSS is known to have
+ * more enabled. Without CFG-GNSS the caller is trusted.
+ */
+TEasyUBXError eubx_set_measurement_rate(struct eubx_handle *pHandle, uint16_t measurement_rate_ms, uint16_t navigation_rate, uint16_t time_reference)
+{
+    TEasyUBXError rc = EUBX_ERROR_NOT_SUPPORTED;
+    bool single_gnss = (1 >= count_constellations(&pHandle->receiver_config.gnss));
+
+    if ((0 < navigation_rate) && (eubx_get_min_measurement_rate(pHandle, single_gnss) <= measurement_rate_ms))
+    {
+        pHandle->send_message.message_class = EUBX_CLASS_CFG;
+        pHandle->send_message.message_id = EUBX_ID_CFG_RATE;
+        pHandle->send_message.message_length = EUBX_LENGTH_CFG_RATE;
+
+        eubx_drv_store_u16(&pHandle->send_message.message_buffer[0], measurement_rate_ms);
+        eubx_drv_store_u16(&pHandle->send_message.message_buffer[2], navigation_rate);
+        eubx_drv_store_u16(&pHandle->send_message.message_buffer[4], time_reference);
+
+        rc = eubx_send_message_wait4ack(pHandle, EUBX_CLASS_CFG, EUBX_ID_CFG_RATE);
+    }
+
+    if (EUBX_ERROR_OK == rc)
+    {
+        pHandle->receiver_config.measurement_rate = measurement_rate_ms;
+        pHandle->receiver_config.navigation_rate = navigation_rate;
+        pHandle->receiver_config.rate_time_reference = time_reference;
+    }
+    else
+    {
+        pHandle->last_error = rc;
+    }
+
+    return rc;
+}
+
+/*
+ * Makes a measurement rate reachable before it is set: a rate above what the chipset does
+ * with concurrent constellations drops to GPS, and the plan is thinned until it fits the
+ * link. The first plan entry is the message the rate is for and keeps its rate, of the
+ * others the one using the most bandwidth is halved until the plan fits. The output is
+ * reduced before the rate goes up, so the link never carries the full plan at the new rate.
+ */
+TEasyUBXError eubx_set_high_rate(struct eubx_handle *pHandle, uint16_t measurement_rate_ms, struct eubx_message_rate *plan, uint8_t count)
+{
+    TEasyUBXError rc = EUBX_ERROR_NOT_SUPPORTED;
+
+    if (eubx_get_min_measurement_rate(pHandle, true) <= measurement_rate_ms)
+    {
+        rc = EUBX_ERROR_OK;
+    }
+
+    if ((EUBX_ERROR_OK == rc) && (eubx_get_min_measurement_rate(pHandle, false) > measurement_rate_ms))
+    {
+        rc = eubx_poll_cfg_gnss(pHandle);
+
+        if ((EUBX_ERROR_OK == rc) && (1 < count_constellations(&pHandle->receiver_config.gnss)))
+        {
+            rc = restrict_to_gps(pHandle);
+        }
+    }
+
+    if ((EUBX_ERROR_OK == rc) && (0 < count))
+    {
+        rc = fit_message_plan(pHandle, plan, count, measurement_rate_ms);
+
+        if (EUBX_ERROR_OK == rc)
+        {
+            rc = eubx_apply_message_plan(pHandle, plan, count);
+        }
+    }
+
+    if (EUBX_ERROR_OK == rc)
+    {
+        rc = eubx_set_measurement_rate(pHandle, measurement_rate_ms, 1, pHandle->receiver_config.rate_time_reference);
+    }
+
+    if (EUBX_ERROR_OK != rc)
+    {
+        pHandle->last_error = rc;
+    }
+
+    return rc;
+}
+
 TEasyUBXError eubx_set_dyn_model(struct eubx_handle * pHandle, TEasyUBXDynamicPlatformModel dyn_model, TEasyUBXFixMode fix_mode)
 {
     pHandle->send_message.message_class = EUBX_CLASS_CFG;
@@ -82,45 +343,237 @@ TEasyUBXError eubx_set_dyn_model(struct eubx_handle * pHandle, TEasyUBXDynamicPl
     return eubx_send_message_wait4ack(pHandle, EUBX_CLASS_CFG, EUBX_ID_CFG_NAV5);
 }
 
-void eubx_drv_handle_receive_class_cfg(struct eubx_handle *pHandle)
+const struct eubx_rate_limits *find_rate_limits(const struct eubx_handle *pHandle)
+{
+    const struct eubx_rate_limits *limits = NULL;
+
+    for (uint8_t i = 0; i < sizeof(rate_limits) / sizeof(rate_limits[0]); i++)
+    {
+        if (pHandle->receiver_info.chipset_version == rate_limits[i].chipset_version)
+        {
+            limits = &rate_limits[i];
+            break;
+        }
+    }
+
+    return limits;
+}
+
+// SBAS, IMES and QZSS augment GPS and do not count as constellations of their own
+uint8_t count_constellations(const struct eubx_gnss_config *gnss)
+{
+    uint8_t count = 0;
+
+    for (uint8_t i = 0; i < gnss->block_count; i++)
+    {
+        uint8_t gnss_id = gnss->blocks[i].gnss_id;
+
+        if ((0 != (gnss->blocks[i].flags & 0x01)) && (EUBX_GNSS_ID_SBAS != gnss_id) && (EUBX_GNSS_ID_IMES != gnss_id) && (EUBX_GNSS_ID_QZSS != gnss_id))
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+TEasyUBXError restrict_to_gps(struct eubx_handle *pHandle)
+{
+    TEasyUBXError rc = EUBX_ERROR_NOT_SUPPORTED;
+    struct eubx_gnss_config gnss = pHandle->receiver_config.gnss;
+    uint8_t *payload = pHandle->send_message.message_buffer;
+
+    pHandle->send_message.message_class = EUBX_CLASS_CFG;
+    pHandle->send_message.message_id = EUBX_ID_CFG_GNSS;
+    pHandle->send_message.message_length = EUBX_LENGTH_CFG_GNSS_HEADER + gnss.block_count * EUBX_LENGTH_CFG_GNSS_BLOCK;
+
+    payload[0] = 0;
+    payload[1] = gnss.hw_channels;
+    payload[2] = gnss.used_channels;
+    payload[3] = gnss.block_count;
+
+    for (uint8_t i = 0; i < gnss.block_count; i++)
+    {
+        uint8_t *block = &payload[EUBX_LENGTH_CFG_GNSS_HEADER + i * EUBX_LENGTH_CFG_GNSS_BLOCK];
+
+        // QZSS is tracked as part of GPS and stays as it is
+        if (EUBX_GNSS_ID_GPS == gnss.blocks[i].gnss_id)
+        {
+            gnss.blocks[i].flags |= 0x01;
+            rc = EUBX_ERROR_OK;
+        }
+        else if (EUBX_GNSS_ID_QZSS != gnss.blocks[i].gnss_id)
+        {
+            gnss.blocks[i].flags &= ~(uint32_t)0x01;
+        }
+
+        block[0] = gnss.blocks[i].gnss_id;
+        block[1] = gnss.blocks[i].reserved_channels;
+        block[2] = gnss.blocks[i].max_channels;
+        block[3] = 0;
+        eubx_drv_store_u32(&block[4], gnss.blocks[i].flags);
+    }
+
+    if (EUBX_ERROR_OK == rc)
+    {
+        rc = eubx_send_message_wait4ack(pHandle, EUBX_CLASS_CFG, EUBX_ID_CFG_GNSS);
+    }
+
+    if (EUBX_ERROR_OK == rc)
+    {
+        pHandle->receiver_config.gnss = gnss;
+    }
+
+    return rc;
+}
+
+TEasyUBXError fit_message_plan(struct eubx_handle *pHandle, struct eubx_message_rate *plan, uint8_t count, uint16_t measurement_rate_ms)
+{
+    TEasyUBXError rc = EUBX_ERROR_OK;
+    uint8_t port_id = pHandle->receiver_config.port.port_id;
+    uint32_t budget = eubx_drv_link_budget(pHandle);
+
+    while ((0 < budget) && (EUBX_PORT_COUNT > port_id) && (eubx_message_plan_load(plan, count, port_id, measurement_rate_ms, 1) > budget))
+    {
+        uint8_t *widest = NULL;
+        uint32_t widest_load = 0;
+
+        for (uint8_t i = 1; i < count; i++)
+        {
+            uint8_t rate = plan[i].rates[port_id];
+            uint32_t load = eubx_message_plan_load(&plan[i], 1, port_id, measurement_rate_ms, 1);
+
+            if ((0 < rate) && (128 > rate) && (load > widest_load))
+            {
+                widest = &plan[i].rates[port_id];
+                widest_load = load;
+            }
+        }
+
+        if (NULL == widest)
+        {
+            rc = EUBX_ERROR_BANDWIDTH;
+            break;
+        }
+
+        *widest *= 2;
+    }
+
+    return rc;
+}
+
+TEasyUBXError send_plan_requests(struct eubx_handle *pHandle, TEasyUBXRequestType type)
 {
-    switch (pHandle->receive_message.message_id)
+    TEasyUBXError rc = EUBX_ERROR_OK;
+    TEasyUBXError result = EUBX_ERROR_OK;
+
+    for (uint8_t i = 0; i < pHandle->message_plan_count; i++)
     {
-    case EUBX_ID_CFG_ANT:
-        handle_receive_cfg_ant(pHandle);
-        break;
+        if (0 == (pHandle->message_plan_matched & ((uint32_t)1 << i)))
+        {
+            prepare_plan_message(pHandle, &pHandle->message_plan[i], type);
+            result = eubx_send_request(pHandle, type, NULL, NULL);
+
+            // with the request table full the batch drains first, the wait may have used the send buffer
+            if (EUBX_ERROR_BUSY == result)
+            {
+                result = eubx_waitfor_requests(pHandle);
+                rc = (EUBX_ERROR_OK == rc) ? result : rc;
+
+                prepare_plan_message(pHandle, &pHandle->message_plan[i], type);
+                result = eubx_send_request(pHandle, type, NULL, NULL);
+            }
+
+            rc = (EUBX_ERROR_OK == rc) ? result : rc;
+        }
+    }
 
-    case EUBX_ID_CFG_MSG:
-        handle_receive_cfg_msg(pHandle);
-        break;
+    result = eubx_waitfor_requests(pHandle);
 
-    case EUBX_ID_CFG_NAV5:
-        handle_receive_cfg_nav5(pHandle);
-        break;
+    return (EUBX_ERROR_OK == rc) ? result : rc;
+}
 
-    case EUBX_ID_CFG_NMEA:
-        handle_receive_cfg_nmea(pHandle);
-        break;
+void prepare_plan_message(struct eubx_handle *pHandle, const struct eubx_message_rate *entry, TEasyUBXRequestType type)
+{
+    uint8_t *payload = pHandle->send_message.message_buffer;
 
-    case EUBX_ID_CFG_PRT:
-        handle_receive_cfg_prt(pHandle);
-        break;
+    pHandle->send_message.message_class = EUBX_CLASS_CFG;
+    pHandle->send_message.message_id = EUBX_ID_CFG_MSG;
+    pHandle->send_message.message_length = (EUBXRequestSet == type) ? EUBX_LENGTH_CFG_MSG : EUBX_LENGTH_CFG_MSG_POLL;
 
-    case EUBX_ID_CFG_RATE:
-        handle_receive_cfg_rate(pHandle);
-        break;
+    payload[0] = entry->message_class;
+    payload[1] = entry->message_id;
 
-    default:
-        break;
+    if (EUBXRequestSet == type)
+    {
+        memcpy(&payload[2], entry->rates, EUBX_PORT_COUNT);
     }
 }
 
-void handle_receive_cfg_ant(struct eubx_handle *pHandle)
+void handle_receive_cfg_gnss(struct eubx_handle *pHandle)
 {
+    const uint8_t *payload = pHandle->receive_message.message_buffer;
+    struct eubx_gnss_config *gnss = &pHandle->receiver_config.gnss;
+
+    if (EUBX_LENGTH_CFG_GNSS_HEADER > pHandle->receive_message.message_length)
+    {
+        pHandle->last_error = EUBX_ERROR_LENGTH;
+    }
+    else
+    {
+        // blocks beyond the table are constellations of newer receivers, they are left out
+        uint16_t count = (pHandle->receive_message.message_length - EUBX_LENGTH_CFG_GNSS_HEADER) / EUBX_LENGTH_CFG_GNSS_BLOCK;
+
+        count = (payload[3] < count) ? payload[3] : count;
+        gnss->hw_channels = payload[1];
+        gnss->used_channels = payload[2];
+        gnss->block_count = (EUBX_GNSS_BLOCK_COUNT < count) ? EUBX_GNSS_BLOCK_COUNT : count;
+
+        for (uint8_t i = 0; i < gnss->block_count; i++)
+        {
+            const uint8_t *block = &payload[EUBX_LENGTH_CFG_GNSS_HEADER + i * EUBX_LENGTH_CFG_GNSS_BLOCK];
+
+            gnss->blocks[i].gnss_id = block[0];
+            gnss->blocks[i].reserved_channels = block[1];
+            gnss->blocks[i].max_channels = block[2];
+            gnss->blocks[i].flags = eubx_drv_load_u32(&block[4]);
+        }
+
+        eubx_send_notification(pHandle, EUBXReceivedCfgGNSS);
+    }
 }
 
+// answers to polls of the plan being applied mark the entries that already have their rates
 void handle_receive_cfg_msg(struct eubx_handle *pHandle)
 {
+    const uint8_t *payload = pHandle->receive_message.message_buffer;
+
+    // a poll echo or a cut reply must not mark an entry from the bytes of an earlier frame
+    if (EUBX_LENGTH_CFG_MSG > pHandle->receive_message.message_length)
+    {
+        pHandle->last_error = EUBX_ERROR_LENGTH;
+    }
+    else
+    {
+        for (uint8_t i = 0; i < pHandle->message_plan_count; i++)
+        {
+            const struct eubx_message_rate *entry = &pHandle->message_plan[i];
+
+            if ((payload[0] == entry->message_class) && (payload[1] == entry->message_id))
+            {
+                if (0 == memcmp(&payload[2], entry->rates, EUBX_PORT_COUNT))
+                {
+                    pHandle->message_plan_matched |= (uint32_t)1 << i;
+                }
+                else
+                {
+                    pHandle->message_plan_matched &= ~((uint32_t)1 << i);
+                }
+            }
+        }
+
+        eubx_send_notification(pHandle, EUBXReceivedCfgMSG);
+    }
 }
 
 void handle_receive_cfg_nav5(struct eubx_handle *pHandle)
@@ -138,19 +591,39 @@ void handle_receive_cfg_nmea(struct eubx_handle *pHandle)
 
 void handle_receive_cfg_prt(struct eubx_handle *pHandle)
 {
-    eubx_send_notification(pHandle, EUBXReceivedCfgPRT);
+    const uint8_t *payload = pHandle->receive_message.message_buffer;
+    struct eubx_port_config *port = &pHandle->receiver_config.port;
+
+    if (EUBX_LENGTH_CFG_PRT > pHandle->receive_message.message_length)
+    {
+        pHandle->last_error = EUBX_ERROR_LENGTH;
+    }
+    else
+    {
+        port->port_id = payload[0];
+        port->tx_ready = eubx_drv_load_u16(&payload[2]);
+        port->mode = eubx_drv_load_u32(&payload[4]);
+        port->baud_rate = eubx_drv_load_u32(&payload[8]);
+        port->in_proto_mask = eubx_drv_load_u16(&payload[12]);
+        port->out_proto_mask = eubx_drv_load_u16(&payload[14]);
+        port->flags = eubx_drv_load_u16(&payload[16]);
+
+        eubx_send_notification(pHandle, EUBXReceivedCfgPRT);
+    }
 }
 
- void handle_receive_cfg_rate(struct eubx_handle *pHandle)
+void handle_receive_cfg_rate(struct eubx_handle *pHandle)
 {
-    pHandle->receiver_config.measurement_rate = 0;
-    pHandle->receiver_config.navigation_rate = 0;
-
-    pHandle->receiver_config.measurement_rate += pHandle->receive_message.message_buffer[0];
-    pHandle->receiver_config.measurement_rate += pHandle->receive_message.message_buffer[1] * 256;
-
-    pHandle->receiver_config.navigation_rate += pHandle->receive_message.message_buffer[2];
-    pHandle->receiver_config.navigation_rate += pHandle->receive_message.message_buffer[3] * 256;
+    if (EUBX_LENGTH_CFG_RATE > pHandle->receive_message.message_length)
+    {
+        pHandle->last_error = EUBX_ERROR_LENGTH;
+    }
+    else
+    {
+        pHandle->receiver_config.measurement_rate = eubx_drv_load_u16(&pHandle->receive_message.message_buffer[0]);
+        pHandle->receiver_config.navigation_rate = eubx_drv_load_u16(&pHandle->receive_message.message_buffer[2]);
+        pHandle->receiver_config.rate_time_reference = eubx_drv_load_u16(&pHandle->receive_message.message_buffer[4]);
 
-    eubx_send_notification(pHandle, EUBXReceivedCfgRATE);
+        eubx_send_notification(pHandle, EUBXReceivedCfgRATE);
+    }
 }
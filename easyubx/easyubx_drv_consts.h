@@ -40,6 +40,7 @@
 
 #define EUBX_SYNC1 0xb5
 #define EUBX_SYNC2 0x62
+#define EUBX_RTCM3_PREAMBLE 0xd3
 
 #define EUBX_CLASS_NAV 0x01
 #define EUBX_CLASS_RXM 0x02
@@ -55,6 +56,14 @@
 #define EUBX_CLASS_LOG 0x21
 #define EUBX_CLASS_SEC 0x27
 #define EUBX_CLASS_HNR 0x28
+#define EUBX_CLASS_NMEA 0xf0 // standard NMEA sentences in CFG-MSG
+
+#define EUBX_ID_NMEA_GGA 0x00
+#define EUBX_ID_NMEA_GLL 0x01
+#define EUBX_ID_NMEA_GSA 0x02
+#define EUBX_ID_NMEA_GSV 0x03
+#define EUBX_ID_NMEA_RMC 0x04
+#define EUBX_ID_NMEA_VTG 0x05
 
 #define EUBX_ID_ACK_ACK 0x01
 #define EUBX_ID_ACK_NAK 0x00
@@ -178,4 +187,50 @@
 
 #define EUBX_ID_UPD_SOS 0x14
 
+#define EUBX_GNSS_ID_GPS 0
+#define EUBX_GNSS_ID_SBAS 1
+#define EUBX_GNSS_ID_GALILEO 2
+#define EUBX_GNSS_ID_BEIDOU 3
+#define EUBX_GNSS_ID_IMES 4
+#define EUBX_GNSS_ID_QZSS 5
+#define EUBX_GNSS_ID_GLONASS 6
+
+#define EUBX_PORT_ID_UART1 1
+#define EUBX_PORT_ID_UART2 2
+
+// payload lengths of received messages
+#define EUBX_LENGTH_ACK 2
+#define EUBX_LENGTH_CFG_GNSS_HEADER 4 // followed by 8 bytes per constellation
+#define EUBX_LENGTH_CFG_GNSS_BLOCK 8
+#define EUBX_LENGTH_CFG_MSG 8
+#define EUBX_LENGTH_CFG_MSG_POLL 2
+#define EUBX_LENGTH_CFG_NAV5 36
+#define EUBX_LENGTH_CFG_PRT 20
+#define EUBX_LENGTH_CFG_RATE 6
+#define EUBX_LENGTH_MON_HW 60
+#define EUBX_LENGTH_MON_HW_UBLOX6 68 // eight more virtual pins in front of the jamming indicator
+#define EUBX_LENGTH_MON_IO_PORT 20 // one block per port
+#define EUBX_LENGTH_MON_MSGPP 120
+#define EUBX_LENGTH_MON_RXBUF 24
+#define EUBX_LENGTH_MON_TXBUF 28
+#define EUBX_LENGTH_MON_VER_MIN 40 // followed by 30 byte extension strings
+#define EUBX_LENGTH_MON_VER_EXTENSION 30
+#define EUBX_LENGTH_NAV_DOP 18
+#define EUBX_LENGTH_NAV_EOE 4
+#define EUBX_LENGTH_NAV_CLOCK 20
+#define EUBX_LENGTH_NAV_POSLLH 28
+#define EUBX_LENGTH_NAV_PVT_MIN 84 // u-blox 7, u-blox 8 and later append the vehicle heading
+#define EUBX_LENGTH_NAV_PVT 92
+#define EUBX_LENGTH_NAV_SAT_HEADER 8 // followed by 12 bytes per satellite
+#define EUBX_LENGTH_NAV_SAT_SV 12
+#define EUBX_LENGTH_NAV_SOL 52
+#define EUBX_LENGTH_NAV_STATUS 16
+#define EUBX_LENGTH_NAV_SVINFO_HEADER 8 // followed by 12 bytes per channel
+#define EUBX_LENGTH_NAV_SVINFO_CHANNEL 12
+#define EUBX_LENGTH_NAV_TIMEGPS 16
+#define EUBX_LENGTH_NAV_TIMEUTC 20
+#define EUBX_LENGTH_NAV_VELNED 36
+#define EUBX_LENGTH_SEC_UNIQID_MIN 9 // version, three reserved bytes and the five byte id of u-blox 8
+#define EUBX_LENGTH_SEC_UNIQID 10    // six byte id of later generations
+
 #endif /* EASYUBX_DRV_CONSTS_H */
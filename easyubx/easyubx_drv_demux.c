@@ -0,0 +1,341 @@
+/*
+ * source file for the Easy UBX C library for NMEA and RTCM3 frames sharing the port
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <string.h>
+
+#include "easyubx_drv.h"
+#include "easyubx_drv_consts.h"
+#include "easyubx_drv_demux.h"
+#include "easyubx_drv_stats.h"
+
+#define EUBX_NMEA_START '$'
+#define EUBX_NMEA_END '\n'
+#define EUBX_RTCM3_HEADER_LENGTH 3
+#define EUBX_RTCM3_CRC_LENGTH 3
+
+static void deliver_nmea(struct eubx_handle *pHandle, const uint8_t *sentence, size_t length, bool *valid);
+static void deliver_rtcm(struct eubx_handle *pHandle, const uint8_t *frame, size_t length, bool *valid);
+static uint8_t hex_value(uint8_t character);
+
+// CRC-24Q, polynomial 0x1864cfb
+static const uint32_t crc24q_table[256] = {
+    0x000000, 0x864cfb, 0x8ad50d, 0x0c99f6, 0x93e6e1, 0x15aa1a, 0x1933ec, 0x9f7f17,
+    0xa18139, 0x27cdc2, 0x2b5434, 0xad18cf, 0x3267d8, 0xb42b23, 0xb8b2d5, 0x3efe2e,
+    0xc54e89, 0x430272, 0x4f9b84, 0xc9d77f, 0x56a868, 0xd0e493, 0xdc7d65, 0x5a319e,
+    0x64cfb0, 0xe2834b, 0xee1abd, 0x685646, 0xf72951, 0x7165aa, 0x7dfc5c, 0xfbb0a7,
+    0x0cd1e9, 0x8a9d12, 0x8604e4, 0x00481f, 0x9f3708, 0x197bf3, 0x15e205, 0x93aefe,
+    0xad50d0, 0x2b1c2b, 0x2785dd, 0xa1c926, 0x3eb631, 0xb8faca, 0xb4633c, 0x322fc7,
+    0xc99f60, 0x4fd39b, 0x434a6d, 0xc50696, 0x5a7981, 0xdc357a, 0xd0ac8c, 0x56e077,
+    0x681e59, 0xee52a2, 0xe2cb54, 0x6487af, 0xfbf8b8, 0x7db443, 0x712db5, 0xf7614e,
+    0x19a3d2, 0x9fef29, 0x9376df, 0x153a24, 0x8a4533, 0x0c09c8, 0x00903e, 0x86dcc5,
+    0xb822eb, 0x3e6e10, 0x32f7e6, 0xb4bb1d, 0x2bc40a, 0xad88f1, 0xa11107, 0x275dfc,
+    0xdced5b, 0x5aa1a0, 0x563856, 0xd074ad, 0x4f0bba, 0xc94741, 0xc5deb7, 0x43924c,
+    0x7d6c62, 0xfb2099, 0xf7b96f, 0x71f594, 0xee8a83, 0x68c678, 0x645f8e, 0xe21375,
+    0x15723b, 0x933ec0, 0x9fa736, 0x19ebcd, 0x8694da, 0x00d821, 0x0c41d7, 0x8a0d2c,
+    0xb4f302, 0x32bff9, 0x3e260f, 0xb86af4, 0x2715e3, 0xa15918, 0xadc0ee, 0x2b8c15,
+    0xd03cb2, 0x567049, 0x5ae9bf, 0xdca544, 0x43da53, 0xc596a8, 0xc90f5e, 0x4f43a5,
+    0x71bd8b, 0xf7f170, 0xfb6886, 0x7d247d, 0xe25b6a, 0x641791, 0x688e67, 0xeec29c,
+    0x3347a4, 0xb50b5f, 0xb992a9, 0x3fde52, 0xa0a145, 0x26edbe, 0x2a7448, 0xac38b3,
+    0x92c69d, 0x148a66, 0x181390, 0x9e5f6b, 0x01207c, 0x876c87, 0x8bf571, 0x0db98a,
+    0xf6092d, 0x7045d6, 0x7cdc20, 0xfa90db, 0x65efcc, 0xe3a337, 0xef3ac1, 0x69763a,
+    0x578814, 0xd1c4ef, 0xdd5d19, 0x5b11e2, 0xc46ef5, 0x42220e, 0x4ebbf8, 0xc8f703,
+    0x3f964d, 0xb9dab6, 0xb54340, 0x330fbb, 0xac70ac, 0x2a3c57, 0x26a5a1, 0xa0e95a,
+    0x9e1774, 0x185b8f, 0x14c279, 0x928e82, 0x0df195, 0x8bbd6e, 0x872498, 0x016863,
+    0xfad8c4, 0x7c943f, 0x700dc9, 0xf64132, 0x693e25, 0xef72de, 0xe3eb28, 0x65a7d3,
+    0x5b59fd, 0xdd1506, 0xd18cf0, 0x57c00b, 0xc8bf1c, 0x4ef3e7, 0x426a11, 0xc426ea,
+    0x2ae476, 0xaca88d, 0xa0317b, 0x267d80, 0xb90297, 0x3f4e6c, 0x33d79a, 0xb59b61,
+    0x8b654f, 0x0d29b4, 0x01b042, 0x87fcb9, 0x1883ae, 0x9ecf55, 0x9256a3, 0x141a58,
+    0xefaaff, 0x69e604, 0x657ff2, 0xe33309, 0x7c4c1e, 0xfa00e5, 0xf69913, 0x70d5e8,
+    0x4e2bc6, 0xc8673d, 0xc4fecb, 0x42b230, 0xddcd27, 0x5b81dc, 0x57182a, 0xd154d1,
+    0x26359f, 0xa07964, 0xace092, 0x2aac69, 0xb5d37e, 0x339f85, 0x3f0673, 0xb94a88,
+    0x87b4a6, 0x01f85d, 0x0d61ab, 0x8b2d50, 0x145247, 0x921ebc, 0x9e874a, 0x18cbb1,
+    0xe37b16, 0x6537ed, 0x69ae1b, 0xefe2e0, 0x709df7, 0xf6d10c, 0xfa48fa, 0x7c0401,
+    0x42fa2f, 0xc4b6d4, 0xc82f22, 0x4e63d9, 0xd11cce, 0x575035, 0x5bc9c3, 0xdd8538,
+};
+
+uint32_t eubx_crc24q_update(uint32_t crc, const uint8_t *buffer, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        crc = ((crc << 8) & 0xffffff) ^ crc24q_table[((crc >> 16) ^ buffer[i]) & 0xff];
+    }
+
+    return crc;
+}
+
+const uint8_t *eubx_drv_demux_start_nmea(struct eubx_handle *pHandle, const uint8_t *position, const uint8_t *end)
+{
+    size_t available = end - position;
+    const uint8_t *line_end = NULL;
+    const uint8_t *next = position;
+
+    if (EUBX_NMEA_MAX_LENGTH < available)
+    {
+        available = EUBX_NMEA_MAX_LENGTH;
+    }
+
+    line_end = (const uint8_t *)memchr(position, EUBX_NMEA_END, available);
+
+    if (NULL != line_end)
+    {
+        bool valid = false;
+
+        // the sentence is complete in the input, it is handed out without copying
+        deliver_nmea(pHandle, position, line_end + 1 - position, &valid);
+
+        // a '$' without a valid sentence behind it may be part of something else, scan again after it
+        next = valid ? line_end + 1 : position + 1;
+    }
+    else if (EUBX_NMEA_MAX_LENGTH == available)
+    {
+        next = position + 1;
+    }
+    else
+    {
+        pHandle->receive_status = EUBXReceiveNmea;
+        pHandle->receive_position = 0;
+        pHandle->receive_message.message_length = EUBX_NMEA_MAX_LENGTH;
+        eubx_drv_place_receive_message(pHandle);
+    }
+
+    return next;
+}
+
+const uint8_t *eubx_drv_demux_receive_nmea(struct eubx_handle *pHandle, const uint8_t *position, const uint8_t *end)
+{
+    const uint8_t *line_end = (const uint8_t *)memchr(position, EUBX_NMEA_END, end - position);
+    size_t count = (NULL != line_end) ? (size_t)(line_end + 1 - position) : (size_t)(end - position);
+    uint32_t capacity = pHandle->receive_message.message_buffer_size;
+
+    if (EUBX_NMEA_MAX_LENGTH < capacity)
+    {
+        capacity = EUBX_NMEA_MAX_LENGTH;
+    }
+
+    if (capacity - pHandle->receive_position < count)
+    {
+        // too long for a sentence, the remaining bytes are scanned for the next frame
+        EUBX_DRV_STATS_COUNT(pHandle, overflows);
+        pHandle->last_error = EUBX_ERROR_RECEIVE_OVERFLOW;
+        pHandle->receive_status = EUBXReceiveExpectSync1;
+        count = 0;
+    }
+    else
+    {
+        memmove(&pHandle->receive_message.message_buffer[pHandle->receive_position], position, count);
+        pHandle->receive_position += count;
+
+        if (NULL != line_end)
+        {
+            bool valid = false;
+
+            deliver_nmea(pHandle, pHandle->receive_message.message_buffer, pHandle->receive_position, &valid);
+            pHandle->receive_status = EUBXReceiveExpectSync1;
+        }
+    }
+
+    return position + count;
+}
+
+const uint8_t *eubx_drv_demux_start_rtcm(struct eubx_handle *pHandle, const uint8_t *position, const uint8_t *end)
+{
+    size_t available = end - position;
+    const uint8_t *next = position;
+
+    if (EUBX_RTCM3_HEADER_LENGTH > available)
+    {
+        pHandle->receive_status = EUBXReceiveRtcm;
+        pHandle->receive_position = 0;
+    }
+    else if (0 != (position[1] & 0xfc))
+    {
+        // the six reserved bits are zero in every RTCM3 frame
+        next = position + 1;
+    }
+    else
+    {
+        size_t length = ((position[1] & 0x03) << 8) + position[2] + EUBX_RTCM3_HEADER_LENGTH + EUBX_RTCM3_CRC_LENGTH;
+
+        if (length <= available)
+        {
+            bool valid = false;
+
+            deliver_rtcm(pHandle, position, length, &valid);
+            next = valid ? position + length : position + 1;
+        }
+        else
+        {
+            pHandle->receive_status = EUBXReceiveRtcm;
+            pHandle->receive_position = 0;
+        }
+    }
+
+    return next;
+}
+
+const uint8_t *eubx_drv_demux_receive_rtcm(struct eubx_handle *pHandle, const uint8_t *position, const uint8_t *end)
+{
+    const uint8_t *next = position + 1;
+
+    if (0 == pHandle->receive_position)
+    {
+        pHandle->receive_position++;
+    }
+    else if (1 == pHandle->receive_position)
+    {
+        if (0 != (*position & 0xfc))
+        {
+            pHandle->receive_status = EUBXReceiveExpectSync1;
+            next = position;
+        }
+        else
+        {
+            pHandle->receive_message.message_length = (*position & 0x03) << 8;
+            pHandle->receive_position++;
+        }
+    }
+    else if (2 == pHandle->receive_position)
+    {
+        uint16_t payload_length = pHandle->receive_message.message_length + *position;
+
+        pHandle->receive_message.message_length = payload_length + EUBX_RTCM3_HEADER_LENGTH + EUBX_RTCM3_CRC_LENGTH;
+        eubx_drv_place_receive_message(pHandle);
+
+        if (pHandle->receive_message.message_buffer_size < pHandle->receive_message.message_length)
+        {
+            EUBX_DRV_STATS_COUNT(pHandle, overflows);
+            pHandle->last_error = EUBX_ERROR_RECEIVE_OVERFLOW;
+            pHandle->receive_status = EUBXReceiveExpectSync1;
+        }
+        else
+        {
+            // the header is rebuilt from the length, it may have arrived in an earlier chunk
+            pHandle->receive_message.message_buffer[0] = EUBX_RTCM3_PREAMBLE;
+            pHandle->receive_message.message_buffer[1] = payload_length >> 8;
+            pHandle->receive_message.message_buffer[2] = payload_length & 0xff;
+            pHandle->receive_position++;
+        }
+    }
+    else
+    {
+        size_t count = pHandle->receive_message.message_length - pHandle->receive_position;
+
+        if ((size_t)(end - position) < count)
+        {
+            count = end - position;
+        }
+
+        memmove(&pHandle->receive_message.message_buffer[pHandle->receive_position], position, count);
+        pHandle->receive_position += count;
+        next = position + count;
+
+        if (pHandle->receive_position == pHandle->receive_message.message_length)
+        {
+            bool valid = false;
+
+            deliver_rtcm(pHandle, pHandle->receive_message.message_buffer, pHandle->receive_position, &valid);
+            pHandle->receive_status = EUBXReceiveExpectSync1;
+        }
+    }
+
+    return next;
+}
+
+void deliver_nmea(struct eubx_handle *pHandle, const uint8_t *sentence, size_t length, bool *valid)
+{
+    size_t checksum_position = length - 4; // "*hh\n"
+    uint8_t checksum = 0;
+
+    if ((length >= 2) && ('\r' == sentence[length - 2]))
+    {
+        checksum_position--;
+    }
+
+    *valid = (length > 5) && ('*' == sentence[checksum_position]);
+
+    if (*valid)
+    {
+        // XOR over everything between '$' and '*'
+        for (size_t i = 1; i < checksum_position; i++)
+        {
+            checksum ^= sentence[i];
+        }
+
+        *valid = (checksum == ((hex_value(sentence[checksum_position + 1]) << 4) | hex_value(sentence[checksum_position + 2])));
+    }
+
+    if (*valid)
+    {
+        EUBX_DRV_STATS_COUNT(pHandle, nmea_sentences);
+        pHandle->notify_nmea(pHandle->callback_usr_ptr, (const char *)sentence, length);
+    }
+    else
+    {
+        EUBX_DRV_STATS_COUNT(pHandle, checksum_errors);
+        pHandle->last_error = EUBX_ERROR_CHECKSUM;
+    }
+}
+
+void deliver_rtcm(struct eubx_handle *pHandle, const uint8_t *frame, size_t length, bool *valid)
+{
+    size_t data_length = length - EUBX_RTCM3_CRC_LENGTH;
+    uint32_t crc = eubx_crc24q_update(0, frame, data_length);
+
+    *valid = (crc == (((uint32_t)frame[data_length] << 16) | (frame[data_length + 1] << 8) | frame[data_length + 2]));
+
+    if (*valid)
+    {
+        EUBX_DRV_STATS_COUNT(pHandle, rtcm_frames);
+        pHandle->notify_rtcm(pHandle->callback_usr_ptr, frame, length);
+    }
+    else
+    {
+        EUBX_DRV_STATS_COUNT(pHandle, checksum_errors);
+        pHandle->last_error = EUBX_ERROR_CHECKSUM;
+    }
+}
+
+uint8_t hex_value(uint8_t character)
+{
+    uint8_t value = 0xff; // never matches the high nibble of a checksum
+
+    if (('0' <= character) && ('9' >= character))
+    {
+        value = character - '0';
+    }
+    else if (('A' <= character) && ('F' >= character))
+    {
+        value = character - 'A' + 10;
+    }
+    else if (('a' <= character) && ('f' >= character))
+    {
+        value = character - 'a' + 10;
+    }
+
+    return value;
+}
@@ -0,0 +1,49 @@
+/*
+ * include file for the Easy UBX C library for NMEA and RTCM3 frames sharing the port
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef EASYUBX_DRV_DEMUX_H
+#define EASYUBX_DRV_DEMUX_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    const uint8_t *eubx_drv_demux_start_nmea(struct eubx_handle *pHandle, const uint8_t *position, const uint8_t *end);
+    const uint8_t *eubx_drv_demux_receive_nmea(struct eubx_handle *pHandle, const uint8_t *position, const uint8_t *end);
+    const uint8_t *eubx_drv_demux_start_rtcm(struct eubx_handle *pHandle, const uint8_t *position, const uint8_t *end);
+    const uint8_t *eubx_drv_demux_receive_rtcm(struct eubx_handle *pHandle, const uint8_t *position, const uint8_t *end);
+
+    // provided by easyubx_drv.c, points the receive message into the storage for message_length bytes
+    void eubx_drv_place_receive_message(struct eubx_handle *pHandle);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* EASYUBX_DRV_DEMUX_H */
@@ -0,0 +1,232 @@
+/*
+ * source file for the Easy UBX C library for the navigation epoch assembler
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <string.h>
+
+#include "easyubx_drv.h"
+#include "easyubx_drv_epoch.h"
+#include "easyubx_drv_snapshot.h"
+#include "easyubx_drv_stats.h"
+
+#define EUBX_DRV_WEEK_MS 604800000 // iTOW runs from 0 to the end of the GPS week
+
+#if EUBX_NAV_EPOCH_ENABLED
+static void close_epoch(struct eubx_handle *pHandle, TEasyUBXEpochClose reason);
+static uint8_t count_bits(uint8_t bits);
+static int32_t itow_distance(uint32_t itow_ms, uint32_t reference_ms);
+static void merge_message(struct eubx_handle *pHandle, uint8_t message);
+#endif
+
+void eubx_drv_epoch_reset(struct eubx_handle *pHandle, eubx_notify_epoch notify_epoch)
+{
+#if EUBX_NAV_EPOCH_ENABLED
+    pHandle->notify_epoch = notify_epoch;
+    pHandle->nav_epoch_itow_ms = 0;
+    pHandle->nav_epoch_time = 0;
+    pHandle->nav_epoch_messages = 0;
+    pHandle->nav_epoch_expected = 0;
+    pHandle->nav_epoch_missing = 0;
+    pHandle->nav_epoch_late = 0;
+    pHandle->nav_eoe_seen = false;
+    memset(&pHandle->nav_epoch, 0, sizeof(pHandle->nav_epoch));
+    eubx_drv_snapshot_reset(pHandle);
+#endif
+}
+
+/*
+ * Called after a NAV message was decoded into the handle. A frame up to
+ * EUBX_NAV_EPOCH_LATE_MS older than the open or the last closed epoch is late and only
+ * counted, any other iTOW than the one of the open epoch closes it and starts the next.
+ */
+void eubx_drv_epoch_add(struct eubx_handle *pHandle, uint32_t itow_ms, uint8_t message)
+{
+#if EUBX_NAV_EPOCH_ENABLED
+    bool open = (0 != pHandle->nav_epoch_messages);
+    int32_t distance = itow_distance(itow_ms, open ? pHandle->nav_epoch_itow_ms : pHandle->nav_epoch.itow_ms);
+
+    // the iTOW of the last closed epoch is late too, that one was ended already
+    if ((open || (0 < pHandle->nav_epoch.number)) && ((0 > distance) || (!open && (0 == distance))) &&
+        (-EUBX_NAV_EPOCH_LATE_MS <= distance))
+    {
+        pHandle->nav_epoch_late++;
+        EUBX_DRV_STATS_COUNT(pHandle, nav_late_frames);
+    }
+    else
+    {
+        if (open && (0 != distance))
+        {
+            close_epoch(pHandle, EUBXEpochNextITOW);
+        }
+
+        pHandle->nav_epoch_itow_ms = itow_ms;
+        pHandle->nav_epoch_messages |= message;
+        pHandle->nav_epoch_time = pHandle->receive_time;
+        merge_message(pHandle, message);
+    }
+#endif
+}
+
+void eubx_drv_epoch_end(struct eubx_handle *pHandle, uint32_t itow_ms)
+{
+#if EUBX_NAV_EPOCH_ENABLED
+    pHandle->nav_eoe_seen = true;
+
+    // NAV-EOE of an epoch without enabled messages or one already closed by the next iTOW
+    if ((0 != pHandle->nav_epoch_messages) && (itow_ms == pHandle->nav_epoch_itow_ms))
+    {
+        close_epoch(pHandle, EUBXEpochEnd);
+    }
+#endif
+}
+
+void eubx_drv_epoch_check_timeout(struct eubx_handle *pHandle)
+{
+#if EUBX_NAV_EPOCH_ENABLED
+    // with NAV-EOE a slow link must not split an epoch, the next iTOW covers a lost NAV-EOE
+    if ((0 != pHandle->nav_epoch_messages) && !pHandle->nav_eoe_seen && (NULL != pHandle->get_time) &&
+        (pHandle->get_time(pHandle->callback_usr_ptr) - pHandle->nav_epoch_time >= EUBX_NAV_EPOCH_TIMEOUT_MS * 1000))
+    {
+        close_epoch(pHandle, EUBXEpochTimeout);
+    }
+#endif
+}
+
+uint32_t eubx_drv_epoch_time_to_deadline(const struct eubx_handle *pHandle, uint32_t now)
+{
+    uint32_t remaining_us = EUBX_NO_DEADLINE;
+
+#if EUBX_NAV_EPOCH_ENABLED
+    // the same condition as the timeout check, receivers with NAV-EOE never wait for it
+    if ((0 != pHandle->nav_epoch_messages) && !pHandle->nav_eoe_seen)
+    {
+        uint32_t elapsed_us = now - pHandle->nav_epoch_time;
+
+        remaining_us = (elapsed_us < EUBX_NAV_EPOCH_TIMEOUT_MS * 1000) ? EUBX_NAV_EPOCH_TIMEOUT_MS * 1000 - elapsed_us : 0;
+    }
+#endif
+
+    return remaining_us;
+}
+
+#if EUBX_NAV_EPOCH_ENABLED
+void close_epoch(struct eubx_handle *pHandle, TEasyUBXEpochClose reason)
+{
+    struct eubx_nav_epoch *epoch = &pHandle->nav_epoch;
+    uint8_t missing = pHandle->nav_epoch_expected & ~pHandle->nav_epoch_messages;
+
+    epoch->number++;
+    epoch->itow_ms = pHandle->nav_epoch_itow_ms;
+    epoch->closed_by = reason;
+    epoch->messages = pHandle->nav_epoch_messages;
+    epoch->expected = pHandle->nav_epoch_expected | pHandle->nav_epoch_messages;
+    epoch->dropped = count_bits(missing);
+    epoch->late = pHandle->nav_epoch_late;
+
+    // a message missing twice in a row was disabled rather than lost
+    pHandle->nav_epoch_expected = pHandle->nav_epoch_messages | (missing & ~pHandle->nav_epoch_missing);
+    pHandle->nav_epoch_missing = missing;
+    pHandle->nav_epoch_messages = 0;
+    pHandle->nav_epoch_late = 0;
+
+    EUBX_DRV_STATS_COUNT(pHandle, nav_epochs);
+
+    if (0 != missing)
+    {
+        EUBX_DRV_STATS_COUNT(pHandle, nav_incomplete_epochs);
+    }
+
+    eubx_drv_snapshot_publish(pHandle);
+
+    if (NULL != pHandle->notify_epoch)
+    {
+        pHandle->notify_epoch(pHandle->callback_usr_ptr, epoch);
+    }
+
+    eubx_send_notification(pHandle, EUBXNavEpochPublished);
+}
+
+uint8_t count_bits(uint8_t bits)
+{
+    uint8_t count = 0;
+
+    for (; 0 != bits; bits &= bits - 1)
+    {
+        count++;
+    }
+
+    return count;
+}
+
+// signed distance within the week, so the first iTOW of a week follows the last one of the week before
+int32_t itow_distance(uint32_t itow_ms, uint32_t reference_ms)
+{
+    int32_t distance = (int32_t)((itow_ms % EUBX_DRV_WEEK_MS + EUBX_DRV_WEEK_MS - reference_ms % EUBX_DRV_WEEK_MS) % EUBX_DRV_WEEK_MS);
+
+    if (EUBX_DRV_WEEK_MS / 2 < distance)
+    {
+        distance -= EUBX_DRV_WEEK_MS;
+    }
+
+    return distance;
+}
+
+void merge_message(struct eubx_handle *pHandle, uint8_t message)
+{
+    struct eubx_nav_epoch *epoch = &pHandle->nav_epoch;
+
+    switch (message)
+    {
+    case EUBX_NAV_MESSAGE_PVT:
+        epoch->pvt = pHandle->nav_pvt;
+        break;
+
+    case EUBX_NAV_MESSAGE_POSLLH:
+        epoch->posllh = pHandle->nav_posllh;
+        break;
+
+    case EUBX_NAV_MESSAGE_VELNED:
+        epoch->velned = pHandle->nav_velned;
+        break;
+
+    case EUBX_NAV_MESSAGE_SOL:
+        epoch->sol = pHandle->nav_sol;
+        break;
+
+    case EUBX_NAV_MESSAGE_DOP:
+        epoch->dop = pHandle->nav_dop;
+        break;
+
+    case EUBX_NAV_MESSAGE_TIMEUTC:
+        epoch->timeutc = pHandle->nav_timeutc;
+        break;
+
+    default:
+        break;
+    }
+}
+#endif
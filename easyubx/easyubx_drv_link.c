@@ -0,0 +1,310 @@
+/*
+ * Link bring-up for the Easy UBX C library: baud rate detection, upgrade and message plan budget
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "easyubx_drv.h"
+#include "easyubx_drv_consts.h"
+#include "easyubx_drv_link.h"
+
+#define EUBX_LINK_BITS_PER_BYTE 10 // start and stop bit around 8N1 data
+#define EUBX_LINK_NOMINAL_SVS 32   // satellites assumed in NAV-SAT and NAV-SVINFO
+#define EUBX_LINK_NOMINAL_PAYLOAD 64 // messages without an entry below
+
+struct eubx_link_payload
+{
+    uint8_t message_class;
+    uint8_t message_id;
+    uint16_t length;
+};
+
+// ordered by how often receivers are found at the rate, the factory default first
+static const uint32_t common_baud_rates[] = {9600, 38400, 115200, 230400, 460800, 921600, 57600, 19200, 4800};
+
+static const struct eubx_link_payload nominal_payloads[] = {
+    {EUBX_CLASS_NAV, EUBX_ID_NAV_CLOCK, EUBX_LENGTH_NAV_CLOCK},
+    {EUBX_CLASS_NAV, EUBX_ID_NAV_DOP, EUBX_LENGTH_NAV_DOP},
+    {EUBX_CLASS_NAV, EUBX_ID_NAV_EOE, EUBX_LENGTH_NAV_EOE},
+    {EUBX_CLASS_NAV, EUBX_ID_NAV_POSLLH, EUBX_LENGTH_NAV_POSLLH},
+    {EUBX_CLASS_NAV, EUBX_ID_NAV_PVT, EUBX_LENGTH_NAV_PVT},
+    {EUBX_CLASS_NAV, EUBX_ID_NAV_SAT, EUBX_LENGTH_NAV_SAT_HEADER + EUBX_LINK_NOMINAL_SVS * EUBX_LENGTH_NAV_SAT_SV},
+    {EUBX_CLASS_NAV, EUBX_ID_NAV_SOL, EUBX_LENGTH_NAV_SOL},
+    {EUBX_CLASS_NAV, EUBX_ID_NAV_STATUS, EUBX_LENGTH_NAV_STATUS},
+    {EUBX_CLASS_NAV, EUBX_ID_NAV_SVINFO, EUBX_LENGTH_NAV_SVINFO_HEADER + EUBX_LINK_NOMINAL_SVS * EUBX_LENGTH_NAV_SVINFO_CHANNEL},
+    {EUBX_CLASS_NAV, EUBX_ID_NAV_TIMEGPS, EUBX_LENGTH_NAV_TIMEGPS},
+    {EUBX_CLASS_NAV, EUBX_ID_NAV_TIMEUTC, EUBX_LENGTH_NAV_TIMEUTC},
+    {EUBX_CLASS_NAV, EUBX_ID_NAV_VELENED, EUBX_LENGTH_NAV_VELNED},
+    {EUBX_CLASS_MON, EUBX_ID_MON_HW, EUBX_LENGTH_MON_HW},
+    {EUBX_CLASS_MON, EUBX_ID_MON_RXBUF, EUBX_LENGTH_MON_RXBUF},
+    {EUBX_CLASS_MON, EUBX_ID_MON_TXBUF, EUBX_LENGTH_MON_TXBUF},
+};
+
+static TEasyUBXError probe_baud(struct eubx_handle *pHandle, uint32_t baud_rate);
+static TEasyUBXError switch_baud(struct eubx_handle *pHandle, uint32_t baud_rate);
+static uint16_t nominal_payload(uint8_t message_class, uint8_t message_id);
+
+TEasyUBXError eubx_detect_baud(struct eubx_handle *pHandle, const uint32_t *candidates, uint8_t count)
+{
+    TEasyUBXError rc = EUBX_ERROR_NOT_SUPPORTED;
+    uint32_t current = pHandle->baud_rate;
+
+    if (NULL == candidates)
+    {
+        candidates = common_baud_rates;
+        count = sizeof(common_baud_rates) / sizeof(common_baud_rates[0]);
+    }
+
+    // a wrong rate never answers, without a clock the probe would wait forever
+    if ((NULL != pHandle->set_baud) && (NULL != pHandle->get_time))
+    {
+        rc = EUBX_ERROR_TIMEOUT;
+
+        // the rate the port is open with costs no switch and is right most of the time
+        if (0 != current)
+        {
+            rc = probe_baud(pHandle, current);
+        }
+
+        for (uint8_t i = 0; (EUBX_ERROR_OK != rc) && (i < count); i++)
+        {
+            if (candidates[i] != current)
+            {
+                rc = switch_baud(pHandle, candidates[i]);
+            }
+        }
+    }
+
+    if (EUBX_ERROR_OK != rc)
+    {
+        pHandle->last_error = rc;
+    }
+
+    return rc;
+}
+
+/*
+ * Moves the receiver port to the highest candidate above the current rate that answers
+ * at the new rate. A candidate that fails is undone by returning to the old rate; if the
+ * receiver is not found there either, it is searched for among all candidates.
+ */
+TEasyUBXError eubx_upgrade_baud(struct eubx_handle *pHandle, const uint32_t *candidates, uint8_t count)
+{
+    TEasyUBXError rc = EUBX_ERROR_OK;
+    uint32_t tried = 0;
+
+    if (NULL == candidates)
+    {
+        candidates = common_baud_rates;
+        count = sizeof(common_baud_rates) / sizeof(common_baud_rates[0]);
+    }
+
+    if (0 == pHandle->receiver_config.port.baud_rate)
+    {
+        rc = eubx_detect_baud(pHandle, candidates, count);
+    }
+
+    if ((EUBX_ERROR_OK == rc) && (EUBX_PORT_ID_UART1 != pHandle->receiver_config.port.port_id) && (EUBX_PORT_ID_UART2 != pHandle->receiver_config.port.port_id))
+    {
+        rc = EUBX_ERROR_NOT_SUPPORTED;
+    }
+
+    while (EUBX_ERROR_OK == rc)
+    {
+        struct eubx_port_config port = pHandle->receiver_config.port;
+        uint32_t previous = port.baud_rate;
+
+        // the highest untried candidate, the list order does not matter
+        for (uint8_t i = 0; i < count; i++)
+        {
+            if ((candidates[i] > port.baud_rate) && ((candidates[i] < tried) || (0 == tried)))
+            {
+                port.baud_rate = candidates[i];
+            }
+        }
+
+        if (port.baud_rate == previous)
+        {
+            break;
+        }
+
+        tried = port.baud_rate;
+
+        // the receiver is only told to switch once the host is known to follow
+        if (!pHandle->set_baud(pHandle->callback_usr_ptr, port.baud_rate) || !pHandle->set_baud(pHandle->callback_usr_ptr, previous))
+        {
+            rc = switch_baud(pHandle, previous);
+            continue;
+        }
+
+        rc = eubx_set_cfg_port(pHandle, &port);
+
+        if (EUBX_ERROR_OK == rc)
+        {
+            rc = switch_baud(pHandle, port.baud_rate);
+        }
+
+        if (EUBX_ERROR_OK == rc)
+        {
+            break;
+        }
+
+        rc = switch_baud(pHandle, previous);
+
+        if (EUBX_ERROR_OK != rc)
+        {
+            rc = eubx_detect_baud(pHandle, candidates, count);
+            break;
+        }
+    }
+
+    return rc;
+}
+
+uint32_t eubx_message_plan_load(const struct eubx_message_rate *plan, uint8_t count, uint8_t port_id, uint16_t measurement_rate_ms, uint16_t navigation_rate)
+{
+    uint32_t solution_ms = (0 < measurement_rate_ms) ? measurement_rate_ms : 1000;
+    uint32_t load = 0; // per solution in thousandths of a byte, exact for every nth solution
+
+    if (0 < navigation_rate)
+    {
+        solution_ms *= navigation_rate;
+    }
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        uint32_t frame = nominal_payload(plan[i].message_class, plan[i].message_id) + EUBX_FRAME_OVERHEAD;
+        uint8_t rate = (EUBX_PORT_COUNT > port_id) ? plan[i].rates[port_id] : 0;
+
+        // a rate of n sends the message every nth solution
+        if (0 < rate)
+        {
+            load += (frame * 1000 + rate - 1) / rate;
+        }
+    }
+
+    return (load + solution_ms - 1) / solution_ms;
+}
+
+TEasyUBXError eubx_check_message_plan(const struct eubx_handle *pHandle, const struct eubx_message_rate *plan, uint8_t count)
+{
+    TEasyUBXError rc = EUBX_ERROR_OK;
+    uint32_t budget = eubx_drv_link_budget(pHandle);
+    uint32_t load = eubx_message_plan_load(plan, count, pHandle->receiver_config.port.port_id, pHandle->receiver_config.measurement_rate, pHandle->receiver_config.navigation_rate);
+
+    if ((0 < budget) && (load > budget))
+    {
+        rc = EUBX_ERROR_BANDWIDTH;
+    }
+
+    return rc;
+}
+
+uint32_t eubx_drv_link_budget(const struct eubx_handle *pHandle)
+{
+    uint32_t budget = 0;
+
+    // USB, SPI and I2C ports have no rate of their own
+    if ((EUBX_PORT_ID_UART1 == pHandle->receiver_config.port.port_id) || (EUBX_PORT_ID_UART2 == pHandle->receiver_config.port.port_id))
+    {
+        budget = (uint32_t)((uint64_t)pHandle->receiver_config.port.baud_rate * EUBX_LINK_LOAD_PERCENT / (100 * EUBX_LINK_BITS_PER_BYTE));
+    }
+
+    return budget;
+}
+
+uint32_t eubx_drv_link_probe_timeout(uint32_t baud_rate)
+{
+    return EUBX_LINK_PROBE_TIMEOUT_MS + (uint32_t)((uint64_t)EUBX_LINK_PROBE_BACKLOG * EUBX_LINK_BITS_PER_BYTE * 1000 / baud_rate);
+}
+
+uint32_t eubx_drv_link_common_rate(uint8_t index)
+{
+    return (index < sizeof(common_baud_rates) / sizeof(common_baud_rates[0])) ? common_baud_rates[index] : 0;
+}
+
+/*
+ * Polls the port configuration, the answer is short enough for any receive buffer
+ * and tells the port and rate an upgrade starts from. The ACK follows the answer.
+ */
+TEasyUBXError probe_baud(struct eubx_handle *pHandle, uint32_t baud_rate)
+{
+    TEasyUBXError rc = EUBX_ERROR_TIMEOUT;
+    uint32_t timeout_ms = eubx_drv_link_probe_timeout(baud_rate);
+
+    for (uint8_t attempt = 0; (EUBX_ERROR_OK != rc) && (attempt < EUBX_LINK_PROBE_ATTEMPTS); attempt++)
+    {
+        pHandle->send_message.message_class = EUBX_CLASS_CFG;
+        pHandle->send_message.message_id = EUBX_ID_CFG_PRT;
+        pHandle->send_message.message_length = 0;
+
+        rc = eubx_send_message(pHandle);
+
+        if (EUBX_ERROR_OK == rc)
+        {
+            rc = eubx_waitfor_ack_timeout(pHandle, EUBX_CLASS_CFG, EUBX_ID_CFG_PRT, timeout_ms);
+        }
+    }
+
+    if (EUBX_ERROR_OK == rc)
+    {
+        pHandle->baud_rate = baud_rate;
+        pHandle->last_error = EUBX_ERROR_OK;
+    }
+
+    return rc;
+}
+
+TEasyUBXError switch_baud(struct eubx_handle *pHandle, uint32_t baud_rate)
+{
+    TEasyUBXError rc = EUBX_ERROR_NOT_SUPPORTED;
+
+    if (pHandle->set_baud(pHandle->callback_usr_ptr, baud_rate))
+    {
+        // a frame cut by the switch would swallow the first bytes at the new rate
+        pHandle->receive_status = EUBXReceiveExpectSync1;
+        pHandle->baud_rate = baud_rate;
+
+        rc = probe_baud(pHandle, baud_rate);
+    }
+
+    return rc;
+}
+
+uint16_t nominal_payload(uint8_t message_class, uint8_t message_id)
+{
+    uint16_t length = EUBX_LINK_NOMINAL_PAYLOAD;
+
+    for (uint8_t i = 0; i < sizeof(nominal_payloads) / sizeof(nominal_payloads[0]); i++)
+    {
+        if ((message_class == nominal_payloads[i].message_class) && (message_id == nominal_payloads[i].message_id))
+        {
+            length = nominal_payloads[i].length;
+            break;
+        }
+    }
+
+    return length;
+}
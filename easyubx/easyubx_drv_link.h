@@ -0,0 +1,45 @@
+/*
+ * include file for the Easy UBX C library for the link bring-up
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef EASYUBX_DRV_LINK_H
+#define EASYUBX_DRV_LINK_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    uint32_t eubx_drv_link_budget(const struct eubx_handle *pHandle); // bytes per second a message plan may use, 0 without a limit
+    uint32_t eubx_drv_link_probe_timeout(uint32_t baud_rate);
+    uint32_t eubx_drv_link_common_rate(uint8_t index); // 0 behind the last one
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* EASYUBX_DRV_LINK_H */
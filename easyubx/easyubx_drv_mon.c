@@ -31,20 +31,40 @@
 #include "easyubx_drv.h"
 #include "easyubx_drv_consts.h"
 #include "easyubx_drv_mon.h"
+#include "easyubx_drv_util.h"
 
-static void handle_receive_mon_batch(struct eubx_handle *pHandle);
 static void handle_receive_mon_gnss(struct eubx_handle *pHandle);
-static void handle_receive_mon_hw2(struct eubx_handle *pHandle);
 static void handle_receive_mon_hw(struct eubx_handle *pHandle);
 static void handle_receive_mon_io(struct eubx_handle *pHandle);
 static void handle_receive_mon_msgpp(struct eubx_handle *pHandle);
-static void handle_receive_mon_patch(struct eubx_handle *pHandle);
 static void handle_receive_mon_rxbuf(struct eubx_handle *pHandle);
-static void handle_receive_mon_rxr(struct eubx_handle *pHandle);
-static void handle_receive_mon_smgr(struct eubx_handle *pHandle);
 static void handle_receive_mon_txbuf(struct eubx_handle *pHandle);
 static void handle_receive_mon_ver(struct eubx_handle *pHandle);
 
+static const eubx_drv_handler mon_handlers[] = {
+    [EUBX_ID_MON_GNSS] = handle_receive_mon_gnss,
+    [EUBX_ID_MON_HW] = handle_receive_mon_hw,
+    [EUBX_ID_MON_IO] = handle_receive_mon_io,
+    [EUBX_ID_MON_MSGPP] = handle_receive_mon_msgpp,
+    [EUBX_ID_MON_RXBUF] = handle_receive_mon_rxbuf,
+    [EUBX_ID_MON_TXBUF] = handle_receive_mon_txbuf,
+    [EUBX_ID_MON_VER] = handle_receive_mon_ver,
+};
+
+static const struct eubx_drv_length mon_lengths[] = {
+    [EUBX_ID_MON_HW] = {EUBX_LENGTH_MON_HW, EUBX_LENGTH_MON_HW_UBLOX6},
+    [EUBX_ID_MON_IO] = {EUBX_LENGTH_MON_IO_PORT, EUBX_LENGTH_MON_IO_PORT * EUBX_MON_PORT_COUNT},
+    [EUBX_ID_MON_MSGPP] = {EUBX_LENGTH_MON_MSGPP, EUBX_LENGTH_MON_MSGPP},
+    [EUBX_ID_MON_RXBUF] = {EUBX_LENGTH_MON_RXBUF, EUBX_LENGTH_MON_RXBUF},
+    [EUBX_ID_MON_TXBUF] = {EUBX_LENGTH_MON_TXBUF, EUBX_LENGTH_MON_TXBUF},
+    [EUBX_ID_MON_VER] = {EUBX_LENGTH_MON_VER_MIN, UINT16_MAX},
+};
+
+// sampled at a low rate, the counters only change slowly and the answers cost bandwidth
+static const uint8_t telemetry_ids[] = {EUBX_ID_MON_IO, EUBX_ID_MON_RXBUF, EUBX_ID_MON_TXBUF, EUBX_ID_MON_MSGPP, EUBX_ID_MON_HW};
+
+const struct eubx_drv_dispatch eubx_drv_mon_dispatch = EUBX_DRV_DISPATCH_CHECKED(mon_handlers, mon_lengths);
+
 TEasyUBXError eubx_poll_mon_gnss_selection(struct eubx_handle *pHandle)
 {
     pHandle->send_message.message_class = EUBX_CLASS_MON;
@@ -66,71 +86,22 @@ TEasyUBXError eubx_poll_mon_version(struct eubx_handle *pHandle)
 
     if (EUBX_ERROR_OK == rc)
     {
-        eubx_waitfor_event(pHandle, EUBXReceivedMonVersion);
+        rc = eubx_waitfor_event(pHandle, EUBXReceivedMonVersion);
     }
 
     return rc;
 }
 
-void eubx_drv_handle_receive_class_mon(struct eubx_handle *pHandle)
+TEasyUBXError eubx_schedule_mon_telemetry(struct eubx_handle *pHandle, uint32_t interval_ms)
 {
-    switch (pHandle->receive_message.message_id)
-    {
-    case EUBX_ID_MON_BATCH:
-        handle_receive_mon_batch(pHandle);
-        break;
-
-    case EUBX_ID_MON_GNSS:
-        handle_receive_mon_gnss(pHandle);
-        break;
-
-    case EUBX_ID_MON_HW2:
-        handle_receive_mon_hw2(pHandle);
-        break;
-
-    case EUBX_ID_MON_HW:
-        handle_receive_mon_hw(pHandle);
-        break;
-
-    case EUBX_ID_MON_IO:
-        handle_receive_mon_io(pHandle);
-        break;
-
-    case EUBX_ID_MON_MSGPP:
-        handle_receive_mon_msgpp(pHandle);
-        break;
-
-    case EUBX_ID_MON_PATCH:
-        handle_receive_mon_patch(pHandle);
-        break;
-
-    case EUBX_ID_MON_RXBUF:
-        handle_receive_mon_rxbuf(pHandle);
-        break;
-
-    case EUBX_ID_MON_RXR:
-        handle_receive_mon_rxr(pHandle);
-        break;
-
-    case EUBX_ID_MON_SMGR:
-        handle_receive_mon_smgr(pHandle);
-        break;
-
-    case EUBX_ID_MON_TXBUF:
-        handle_receive_mon_txbuf(pHandle);
-        break;
-
-    case EUBX_ID_MON_VER:
-        handle_receive_mon_ver(pHandle);
-        break;
+    TEasyUBXError rc = EUBX_ERROR_OK;
 
-    default:
-        break;
+    for (size_t i = 0; (EUBX_ERROR_OK == rc) && (i < sizeof(telemetry_ids)); i++)
+    {
+        rc = eubx_schedule_poll(pHandle, EUBX_CLASS_MON, telemetry_ids[i], interval_ms);
     }
-}
 
-void handle_receive_mon_batch(struct eubx_handle *pHandle)
-{
+    return rc;
 }
 
 void handle_receive_mon_gnss(struct eubx_handle *pHandle)
@@ -138,40 +109,139 @@ void handle_receive_mon_gnss(struct eubx_handle *pHandle)
     eubx_send_notification(pHandle, EUBXReceivedMonGNSS);
 }
 
-void handle_receive_mon_hw2(struct eubx_handle *pHandle)
-{
-}
-
 void handle_receive_mon_hw(struct eubx_handle *pHandle)
 {
+    const uint8_t *payload = pHandle->receive_message.message_buffer;
+    struct eubx_mon_hw *hw = &pHandle->mon_hw;
+
+    if (EUBX_LENGTH_MON_HW > pHandle->receive_message.message_length)
+    {
+        pHandle->last_error = EUBX_ERROR_LENGTH;
+    }
+    else
+    {
+        hw->noise_per_ms = eubx_drv_load_u16(&payload[16]);
+        hw->agc_count = eubx_drv_load_u16(&payload[18]);
+        hw->antenna_status = payload[20];
+        hw->antenna_power = payload[21];
+        hw->flags = payload[22];
+        hw->jamming_state = (payload[22] >> 2) & 0x03;
+        hw->jamming_indicator = (EUBX_LENGTH_MON_HW_UBLOX6 <= pHandle->receive_message.message_length) ? payload[53] : payload[45];
+
+        eubx_send_notification(pHandle, EUBXReceivedMonHW);
+    }
 }
 
 void handle_receive_mon_io(struct eubx_handle *pHandle)
 {
+    const uint8_t *payload = pHandle->receive_message.message_buffer;
+    uint16_t count = pHandle->receive_message.message_length / EUBX_LENGTH_MON_IO_PORT;
+
+    if (EUBX_MON_PORT_COUNT < count)
+    {
+        count = EUBX_MON_PORT_COUNT;
+    }
+
+    if (0 == count)
+    {
+        pHandle->last_error = EUBX_ERROR_LENGTH;
+    }
+    else
+    {
+        for (uint16_t i = 0; i < count; i++)
+        {
+            const uint8_t *block = &payload[i * EUBX_LENGTH_MON_IO_PORT];
+            struct eubx_mon_port *port = &pHandle->mon_ports.ports[i];
+
+            port->rx_bytes = eubx_drv_load_u32(&block[0]);
+            port->tx_bytes = eubx_drv_load_u32(&block[4]);
+            port->parity_errors = eubx_drv_load_u16(&block[8]);
+            port->framing_errors = eubx_drv_load_u16(&block[10]);
+            port->overrun_errors = eubx_drv_load_u16(&block[12]);
+            port->break_conditions = eubx_drv_load_u16(&block[14]);
+        }
+
+        pHandle->mon_ports.port_count = (uint8_t)count;
+
+        eubx_send_notification(pHandle, EUBXReceivedMonIO);
+    }
 }
 
 void handle_receive_mon_msgpp(struct eubx_handle *pHandle)
 {
-}
+    const uint8_t *payload = pHandle->receive_message.message_buffer;
 
-void handle_receive_mon_patch(struct eubx_handle *pHandle)
-{
+    if (EUBX_LENGTH_MON_MSGPP > pHandle->receive_message.message_length)
+    {
+        pHandle->last_error = EUBX_ERROR_LENGTH;
+    }
+    else
+    {
+        // six blocks of eight protocol counters, followed by the skipped bytes of every port
+        for (int i = 0; i < EUBX_MON_PORT_COUNT; i++)
+        {
+            struct eubx_mon_port *port = &pHandle->mon_ports.ports[i];
+
+            for (int protocol = 0; protocol < EUBX_MON_PROTOCOL_COUNT; protocol++)
+            {
+                port->messages[protocol] = eubx_drv_load_u16(&payload[(i * EUBX_MON_PROTOCOL_COUNT + protocol) * 2]);
+            }
+
+            port->skipped_bytes = eubx_drv_load_u32(&payload[96 + i * 4]);
+        }
+
+        eubx_send_notification(pHandle, EUBXReceivedMonMSGPP);
+    }
 }
 
 void handle_receive_mon_rxbuf(struct eubx_handle *pHandle)
 {
-}
+    const uint8_t *payload = pHandle->receive_message.message_buffer;
 
-void handle_receive_mon_rxr(struct eubx_handle *pHandle)
-{
-}
+    if (EUBX_LENGTH_MON_RXBUF > pHandle->receive_message.message_length)
+    {
+        pHandle->last_error = EUBX_ERROR_LENGTH;
+    }
+    else
+    {
+        for (int i = 0; i < EUBX_MON_PORT_COUNT; i++)
+        {
+            struct eubx_mon_port *port = &pHandle->mon_ports.ports[i];
 
-void handle_receive_mon_smgr(struct eubx_handle *pHandle)
-{
+            port->rx_pending = eubx_drv_load_u16(&payload[i * 2]);
+            port->rx_usage_percent = payload[12 + i];
+            port->rx_peak_usage_percent = payload[18 + i];
+        }
+
+        eubx_send_notification(pHandle, EUBXReceivedMonRXBUF);
+    }
 }
 
 void handle_receive_mon_txbuf(struct eubx_handle *pHandle)
 {
+    const uint8_t *payload = pHandle->receive_message.message_buffer;
+
+    if (EUBX_LENGTH_MON_TXBUF > pHandle->receive_message.message_length)
+    {
+        pHandle->last_error = EUBX_ERROR_LENGTH;
+    }
+    else
+    {
+        for (int i = 0; i < EUBX_MON_PORT_COUNT; i++)
+        {
+            struct eubx_mon_port *port = &pHandle->mon_ports.ports[i];
+
+            port->tx_pending = eubx_drv_load_u16(&payload[i * 2]);
+            port->tx_usage_percent = payload[12 + i];
+            port->tx_peak_usage_percent = payload[18 + i];
+        }
+
+        pHandle->mon_ports.tx_usage_percent = payload[24];
+        pHandle->mon_ports.tx_peak_usage_percent = payload[25];
+        pHandle->mon_ports.tx_errors = payload[26];
+
+        eubx_send_notification(pHandle, EUBXReceivedMonTXBUF);
+    }
 }
 
 void handle_receive_mon_ver(struct eubx_handle *pHandle)
@@ -216,7 +286,7 @@ void handle_receive_mon_ver(struct eubx_handle *pHandle)
     }
 
     strncpy(pHandle->receiver_info.software_version, (const char *)pHandle->receive_message.message_buffer, EUBX_SW_VERSION_LENGTH);
-    pHandle->receive_message.message_buffer[EUBX_SW_VERSION_LENGTH] = 0;
+    pHandle->receiver_info.software_version[EUBX_SW_VERSION_LENGTH - 1] = 0;
 
     eubx_send_notification(pHandle, EUBXReceivedMonVersion);
 }
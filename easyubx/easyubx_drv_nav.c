@@ -28,13 +28,231 @@
 
 #include "easyubx_drv.h"
 #include "easyubx_drv_consts.h"
+#include "easyubx_drv_epoch.h"
 #include "easyubx_drv_nav.h"
+#include "easyubx_drv_util.h"
 
-void eubx_drv_handle_receive_class_nav(struct eubx_handle *pHandle)
+static void handle_receive_nav_dop(struct eubx_handle *pHandle);
+static void handle_receive_nav_eoe(struct eubx_handle *pHandle);
+static void handle_receive_nav_posllh(struct eubx_handle *pHandle);
+static void handle_receive_nav_pvt(struct eubx_handle *pHandle);
+static void handle_receive_nav_sol(struct eubx_handle *pHandle);
+static void handle_receive_nav_timeutc(struct eubx_handle *pHandle);
+static void handle_receive_nav_velned(struct eubx_handle *pHandle);
+
+static const eubx_drv_handler nav_handlers[] = {
+    [EUBX_ID_NAV_DOP] = handle_receive_nav_dop,
+    [EUBX_ID_NAV_EOE] = handle_receive_nav_eoe,
+    [EUBX_ID_NAV_POSLLH] = handle_receive_nav_posllh,
+    [EUBX_ID_NAV_PVT] = handle_receive_nav_pvt,
+    [EUBX_ID_NAV_SOL] = handle_receive_nav_sol,
+    [EUBX_ID_NAV_TIMEUTC] = handle_receive_nav_timeutc,
+    [EUBX_ID_NAV_VELENED] = handle_receive_nav_velned,
+};
+
+static const struct eubx_drv_length nav_lengths[] = {
+    [EUBX_ID_NAV_DOP] = {EUBX_LENGTH_NAV_DOP, EUBX_LENGTH_NAV_DOP},
+    [EUBX_ID_NAV_EOE] = {EUBX_LENGTH_NAV_EOE, EUBX_LENGTH_NAV_EOE},
+    [EUBX_ID_NAV_POSLLH] = {EUBX_LENGTH_NAV_POSLLH, EUBX_LENGTH_NAV_POSLLH},
+    [EUBX_ID_NAV_PVT] = {EUBX_LENGTH_NAV_PVT_MIN, EUBX_LENGTH_NAV_PVT},
+    [EUBX_ID_NAV_SOL] = {EUBX_LENGTH_NAV_SOL, EUBX_LENGTH_NAV_SOL},
+    [EUBX_ID_NAV_TIMEUTC] = {EUBX_LENGTH_NAV_TIMEUTC, EUBX_LENGTH_NAV_TIMEUTC},
+    [EUBX_ID_NAV_VELENED] = {EUBX_LENGTH_NAV_VELNED, EUBX_LENGTH_NAV_VELNED},
+};
+
+const struct eubx_drv_dispatch eubx_drv_nav_dispatch = EUBX_DRV_DISPATCH_CHECKED(nav_handlers, nav_lengths);
+
+void handle_receive_nav_dop(struct eubx_handle *pHandle)
+{
+    const uint8_t *payload = pHandle->receive_message.message_buffer;
+    struct eubx_nav_dop *dop = &pHandle->nav_dop;
+
+    if (EUBX_LENGTH_NAV_DOP > pHandle->receive_message.message_length)
+    {
+        pHandle->last_error = EUBX_ERROR_LENGTH;
+    }
+    else
+    {
+        dop->itow_ms = eubx_drv_load_u32(&payload[0]);
+        dop->gdop_e2 = eubx_drv_load_u16(&payload[4]);
+        dop->pdop_e2 = eubx_drv_load_u16(&payload[6]);
+        dop->tdop_e2 = eubx_drv_load_u16(&payload[8]);
+        dop->vdop_e2 = eubx_drv_load_u16(&payload[10]);
+        dop->hdop_e2 = eubx_drv_load_u16(&payload[12]);
+        dop->ndop_e2 = eubx_drv_load_u16(&payload[14]);
+        dop->edop_e2 = eubx_drv_load_u16(&payload[16]);
+
+        eubx_drv_epoch_add(pHandle, dop->itow_ms, EUBX_NAV_MESSAGE_DOP);
+        eubx_send_notification(pHandle, EUBXReceivedNavDOP);
+    }
+}
+
+// sent after the last navigation message of an epoch, u-blox 8 and later
+void handle_receive_nav_eoe(struct eubx_handle *pHandle)
 {
-    switch (pHandle->receive_message.message_id)
+    const uint8_t *payload = pHandle->receive_message.message_buffer;
+
+    if (EUBX_LENGTH_NAV_EOE > pHandle->receive_message.message_length)
+    {
+        pHandle->last_error = EUBX_ERROR_LENGTH;
+    }
+    else
+    {
+        eubx_drv_epoch_end(pHandle, eubx_drv_load_u32(&payload[0]));
+    }
+}
+
+void handle_receive_nav_posllh(struct eubx_handle *pHandle)
+{
+    const uint8_t *payload = pHandle->receive_message.message_buffer;
+    struct eubx_nav_posllh *posllh = &pHandle->nav_posllh;
+
+    if (EUBX_LENGTH_NAV_POSLLH > pHandle->receive_message.message_length)
+    {
+        pHandle->last_error = EUBX_ERROR_LENGTH;
+    }
+    else
+    {
+        posllh->itow_ms = eubx_drv_load_u32(&payload[0]);
+        posllh->longitude_deg_e7 = eubx_drv_load_i32(&payload[4]);
+        posllh->latitude_deg_e7 = eubx_drv_load_i32(&payload[8]);
+        posllh->height_mm = eubx_drv_load_i32(&payload[12]);
+        posllh->height_msl_mm = eubx_drv_load_i32(&payload[16]);
+        posllh->horizontal_accuracy_mm = eubx_drv_load_u32(&payload[20]);
+        posllh->vertical_accuracy_mm = eubx_drv_load_u32(&payload[24]);
+
+        eubx_drv_epoch_add(pHandle, posllh->itow_ms, EUBX_NAV_MESSAGE_POSLLH);
+        eubx_send_notification(pHandle, EUBXReceivedNavPOSLLH);
+    }
+}
+
+void handle_receive_nav_pvt(struct eubx_handle *pHandle)
+{
+    const uint8_t *payload = pHandle->receive_message.message_buffer;
+    struct eubx_nav_pvt *pvt = &pHandle->nav_pvt;
+
+    if (EUBX_LENGTH_NAV_PVT_MIN > pHandle->receive_message.message_length)
     {
-    default:
-        break;
+        pHandle->last_error = EUBX_ERROR_LENGTH;
+    }
+    else
+    {
+        pvt->itow_ms = eubx_drv_load_u32(&payload[0]);
+        pvt->year = eubx_drv_load_u16(&payload[4]);
+        pvt->month = payload[6];
+        pvt->day = payload[7];
+        pvt->hour = payload[8];
+        pvt->minute = payload[9];
+        pvt->second = payload[10];
+        pvt->valid = payload[11];
+        pvt->time_accuracy_ns = eubx_drv_load_u32(&payload[12]);
+        pvt->nano_ns = eubx_drv_load_i32(&payload[16]);
+        pvt->fix_type = payload[20];
+        pvt->flags = payload[21];
+        pvt->flags2 = payload[22];
+        pvt->num_sv = payload[23];
+        pvt->longitude_deg_e7 = eubx_drv_load_i32(&payload[24]);
+        pvt->latitude_deg_e7 = eubx_drv_load_i32(&payload[28]);
+        pvt->height_mm = eubx_drv_load_i32(&payload[32]);
+        pvt->height_msl_mm = eubx_drv_load_i32(&payload[36]);
+        pvt->horizontal_accuracy_mm = eubx_drv_load_u32(&payload[40]);
+        pvt->vertical_accuracy_mm = eubx_drv_load_u32(&payload[44]);
+        pvt->velocity_north_mm_s = eubx_drv_load_i32(&payload[48]);
+        pvt->velocity_east_mm_s = eubx_drv_load_i32(&payload[52]);
+        pvt->velocity_down_mm_s = eubx_drv_load_i32(&payload[56]);
+        pvt->ground_speed_mm_s = eubx_drv_load_i32(&payload[60]);
+        pvt->heading_motion_deg_e5 = eubx_drv_load_i32(&payload[64]);
+        pvt->speed_accuracy_mm_s = eubx_drv_load_u32(&payload[68]);
+        pvt->heading_accuracy_deg_e5 = eubx_drv_load_u32(&payload[72]);
+        pvt->pdop_e2 = eubx_drv_load_u16(&payload[76]);
+        pvt->heading_vehicle_deg_e5 = (EUBX_LENGTH_NAV_PVT <= pHandle->receive_message.message_length) ? eubx_drv_load_i32(&payload[84]) : 0;
+
+        eubx_drv_epoch_add(pHandle, pvt->itow_ms, EUBX_NAV_MESSAGE_PVT);
+        eubx_send_notification(pHandle, EUBXReceivedNavPVT);
+    }
+}
+
+void handle_receive_nav_sol(struct eubx_handle *pHandle)
+{
+    const uint8_t *payload = pHandle->receive_message.message_buffer;
+    struct eubx_nav_sol *sol = &pHandle->nav_sol;
+
+    if (EUBX_LENGTH_NAV_SOL > pHandle->receive_message.message_length)
+    {
+        pHandle->last_error = EUBX_ERROR_LENGTH;
+    }
+    else
+    {
+        sol->itow_ms = eubx_drv_load_u32(&payload[0]);
+        sol->ftow_ns = eubx_drv_load_i32(&payload[4]);
+        sol->week = eubx_drv_load_i16(&payload[8]);
+        sol->fix_type = payload[10];
+        sol->flags = payload[11];
+        sol->ecef_x_cm = eubx_drv_load_i32(&payload[12]);
+        sol->ecef_y_cm = eubx_drv_load_i32(&payload[16]);
+        sol->ecef_z_cm = eubx_drv_load_i32(&payload[20]);
+        sol->position_accuracy_cm = eubx_drv_load_u32(&payload[24]);
+        sol->ecef_vx_cm_s = eubx_drv_load_i32(&payload[28]);
+        sol->ecef_vy_cm_s = eubx_drv_load_i32(&payload[32]);
+        sol->ecef_vz_cm_s = eubx_drv_load_i32(&payload[36]);
+        sol->speed_accuracy_cm_s = eubx_drv_load_u32(&payload[40]);
+        sol->pdop_e2 = eubx_drv_load_u16(&payload[44]);
+        sol->num_sv = payload[47];
+
+        eubx_drv_epoch_add(pHandle, sol->itow_ms, EUBX_NAV_MESSAGE_SOL);
+        eubx_send_notification(pHandle, EUBXReceivedNavSOL);
+    }
+}
+
+void handle_receive_nav_timeutc(struct eubx_handle *pHandle)
+{
+    const uint8_t *payload = pHandle->receive_message.message_buffer;
+    struct eubx_nav_timeutc *timeutc = &pHandle->nav_timeutc;
+
+    if (EUBX_LENGTH_NAV_TIMEUTC > pHandle->receive_message.message_length)
+    {
+        pHandle->last_error = EUBX_ERROR_LENGTH;
+    }
+    else
+    {
+        timeutc->itow_ms = eubx_drv_load_u32(&payload[0]);
+        timeutc->time_accuracy_ns = eubx_drv_load_u32(&payload[4]);
+        timeutc->nano_ns = eubx_drv_load_i32(&payload[8]);
+        timeutc->year = eubx_drv_load_u16(&payload[12]);
+        timeutc->month = payload[14];
+        timeutc->day = payload[15];
+        timeutc->hour = payload[16];
+        timeutc->minute = payload[17];
+        timeutc->second = payload[18];
+        timeutc->valid = payload[19];
+
+        eubx_drv_epoch_add(pHandle, timeutc->itow_ms, EUBX_NAV_MESSAGE_TIMEUTC);
+        eubx_send_notification(pHandle, EUBXReceivedNavTIMEUTC);
+    }
+}
+
+void handle_receive_nav_velned(struct eubx_handle *pHandle)
+{
+    const uint8_t *payload = pHandle->receive_message.message_buffer;
+    struct eubx_nav_velned *velned = &pHandle->nav_velned;
+
+    if (EUBX_LENGTH_NAV_VELNED > pHandle->receive_message.message_length)
+    {
+        pHandle->last_error = EUBX_ERROR_LENGTH;
+    }
+    else
+    {
+        velned->itow_ms = eubx_drv_load_u32(&payload[0]);
+        velned->velocity_north_cm_s = eubx_drv_load_i32(&payload[4]);
+        velned->velocity_east_cm_s = eubx_drv_load_i32(&payload[8]);
+        velned->velocity_down_cm_s = eubx_drv_load_i32(&payload[12]);
+        velned->speed_cm_s = eubx_drv_load_u32(&payload[16]);
+        velned->ground_speed_cm_s = eubx_drv_load_u32(&payload[20]);
+        velned->heading_deg_e5 = eubx_drv_load_i32(&payload[24]);
+        velned->speed_accuracy_cm_s = eubx_drv_load_u32(&payload[28]);
+        velned->heading_accuracy_deg_e5 = eubx_drv_load_u32(&payload[32]);
+
+        eubx_drv_epoch_add(pHandle, velned->itow_ms, EUBX_NAV_MESSAGE_VELNED);
+        eubx_send_notification(pHandle, EUBXReceivedNavVELNED);
     }
 }
@@ -29,12 +29,14 @@
 #ifndef EASYUBX_DRV_NAV_H
 #define EASYUBX_DRV_NAV_H
 
+#include "easyubx_drv_util.h"
+
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
-    void eubx_drv_handle_receive_class_nav(struct eubx_handle *pHandle);
+    extern const struct eubx_drv_dispatch eubx_drv_nav_dispatch;
 
 #ifdef __cplusplus
 } // extern "C"
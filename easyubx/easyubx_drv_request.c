@@ -0,0 +1,371 @@
+/*
+ * source file for the Easy UBX C library for pipelined requests
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <string.h>
+
+#include "easyubx_drv.h"
+#include "easyubx_drv_consts.h"
+#include "easyubx_drv_request.h"
+#include "easyubx_drv_stats.h"
+
+static struct eubx_request *find_request(struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id);
+static void complete_request(struct eubx_handle *pHandle, struct eubx_request *request, TEasyUBXError result);
+static uint32_t read_time(struct eubx_handle *pHandle);
+
+TEasyUBXError eubx_send_request(struct eubx_handle *pHandle, TEasyUBXRequestType type, eubx_request_done done, void *usr_ptr)
+{
+    TEasyUBXError rc = EUBX_ERROR_NULLPTR;
+    struct eubx_request *request = NULL;
+
+    if (NULL != pHandle)
+    {
+        rc = EUBX_ERROR_BUSY;
+
+        for (int i = 0; i < EUBX_MAX_PENDING_REQUESTS; i++)
+        {
+            if (!pHandle->requests[i].in_use)
+            {
+                request = &pHandle->requests[i];
+                rc = EUBX_ERROR_OK;
+                break;
+            }
+        }
+    }
+
+    if (EUBX_ERROR_OK == rc)
+    {
+        request->type = type;
+        request->message_class = pHandle->send_message.message_class;
+        request->message_id = pHandle->send_message.message_id;
+        request->response_received = false;
+        request->sequence = pHandle->request_sequence++;
+        request->timeout_ms = eubx_get_timeout(pHandle, request->message_class, request->message_id);
+        request->done = done;
+        request->usr_ptr = usr_ptr;
+
+        rc = eubx_queue_message(pHandle, EUBXPriorityNormal);
+    }
+
+    if (EUBX_ERROR_OK == rc)
+    {
+        request->send_time = pHandle->send_time;
+        request->queued = (0 < pHandle->tx_queue_count);
+        request->in_use = true;
+        pHandle->pending_requests++;
+    }
+
+    return rc;
+}
+
+TEasyUBXError eubx_request_poll(struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id, eubx_request_done done, void *usr_ptr)
+{
+    TEasyUBXError rc = EUBX_ERROR_NULLPTR;
+
+    if (NULL != pHandle)
+    {
+        pHandle->send_message.message_class = message_class;
+        pHandle->send_message.message_id = message_id;
+        pHandle->send_message.message_length = 0;
+
+        rc = eubx_send_request(pHandle, EUBXRequestPoll, done, usr_ptr);
+    }
+
+    return rc;
+}
+
+// for answers whose delay is known better than the round trip history tells
+TEasyUBXError eubx_drv_request_poll_within(struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id, uint32_t timeout_ms, eubx_request_done done, void *usr_ptr)
+{
+    TEasyUBXError rc = eubx_request_poll(pHandle, message_class, message_id, done, usr_ptr);
+
+    for (int i = 0; (EUBX_ERROR_OK == rc) && (i < EUBX_MAX_PENDING_REQUESTS); i++)
+    {
+        struct eubx_request *request = &pHandle->requests[i];
+
+        if (request->in_use && ((uint16_t)(pHandle->request_sequence - 1) == request->sequence))
+        {
+            request->timeout_ms = (EUBX_WAIT_LIMIT_MS < timeout_ms) ? EUBX_WAIT_LIMIT_MS : timeout_ms;
+        }
+    }
+
+    return rc;
+}
+
+uint8_t eubx_pending_requests(const struct eubx_handle *pHandle)
+{
+    return pHandle->pending_requests;
+}
+
+TEasyUBXError eubx_schedule_poll(struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id, uint32_t interval_ms)
+{
+    TEasyUBXError rc = EUBX_ERROR_NULLPTR;
+    struct eubx_poll_entry *entry = NULL;
+    struct eubx_poll_entry *free_entry = NULL;
+
+    if (NULL != pHandle)
+    {
+        rc = (NULL != pHandle->get_time) ? EUBX_ERROR_OK : EUBX_ERROR_NOT_SUPPORTED;
+    }
+
+    for (int i = 0; (EUBX_ERROR_OK == rc) && (i < EUBX_POLL_SCHEDULE_SIZE) && (NULL == entry); i++)
+    {
+        struct eubx_poll_entry *candidate = &pHandle->poll_schedule[i];
+
+        if (0 == candidate->interval_ms)
+        {
+            free_entry = (NULL == free_entry) ? candidate : free_entry;
+        }
+        else if ((message_class == candidate->message_class) && (message_id == candidate->message_id))
+        {
+            entry = candidate;
+        }
+    }
+
+    if ((EUBX_ERROR_OK == rc) && (NULL == entry) && (0 < interval_ms))
+    {
+        entry = free_entry;
+        rc = (NULL != entry) ? EUBX_ERROR_OK : EUBX_ERROR_BUSY;
+    }
+
+    if ((EUBX_ERROR_OK == rc) && (NULL != entry))
+    {
+        // the first poll goes out with the next eubx_loop
+        entry->message_class = message_class;
+        entry->message_id = message_id;
+        // the schedule compares signed differences of the microsecond clock
+        entry->interval_ms = (EUBX_WAIT_LIMIT_MS / 2 < interval_ms) ? EUBX_WAIT_LIMIT_MS / 2 : interval_ms;
+        entry->next_time = read_time(pHandle);
+    }
+
+    return rc;
+}
+
+void eubx_drv_request_reset(struct eubx_handle *pHandle)
+{
+    memset(pHandle->requests, 0, sizeof(pHandle->requests));
+    pHandle->pending_requests = 0;
+    pHandle->request_sequence = 0;
+    pHandle->request_error = EUBX_ERROR_OK;
+}
+
+void eubx_drv_request_handle_message(struct eubx_handle *pHandle)
+{
+    if (0 < pHandle->pending_requests)
+    {
+        struct eubx_request *request = find_request(pHandle, pHandle->receive_message.message_class, pHandle->receive_message.message_id);
+
+        if ((NULL != request) && (EUBXRequestPoll == request->type))
+        {
+            request->response_received = true;
+
+            // CFG polls are acknowledged after the response, all others are done with it
+            if (EUBX_CLASS_CFG != request->message_class)
+            {
+                complete_request(pHandle, request, EUBX_ERROR_OK);
+            }
+        }
+    }
+}
+
+void eubx_drv_request_handle_ack(struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id, bool acknowledged)
+{
+    if (0 < pHandle->pending_requests)
+    {
+        struct eubx_request *request = find_request(pHandle, message_class, message_id);
+
+        if (NULL != request)
+        {
+            if (!acknowledged)
+            {
+                complete_request(pHandle, request, EUBX_ERROR_NAK);
+            }
+            else if ((EUBXRequestSet == request->type) || request->response_received)
+            {
+                complete_request(pHandle, request, EUBX_ERROR_OK);
+            }
+            else
+            {
+                // the response to this poll got lost, it will not arrive after the ACK anymore
+                complete_request(pHandle, request, EUBX_ERROR_TIMEOUT);
+            }
+        }
+    }
+}
+
+void eubx_drv_request_run_schedule(struct eubx_handle *pHandle)
+{
+    if (NULL != pHandle->get_time)
+    {
+        uint32_t now = read_time(pHandle);
+
+        for (int i = 0; i < EUBX_POLL_SCHEDULE_SIZE; i++)
+        {
+            struct eubx_poll_entry *entry = &pHandle->poll_schedule[i];
+
+            // a poll still in flight or without a free request slot is retried with the next loop
+            if ((0 < entry->interval_ms) && (0 <= (int32_t)(now - entry->next_time)) &&
+                (NULL == find_request(pHandle, entry->message_class, entry->message_id)) &&
+                (EUBX_ERROR_OK == eubx_request_poll(pHandle, entry->message_class, entry->message_id, NULL, NULL)))
+            {
+                entry->next_time = now + entry->interval_ms * 1000;
+            }
+        }
+    }
+}
+
+// round trips of queued requests start when their frame goes out, not when it was queued
+void eubx_drv_request_mark_sent(struct eubx_handle *pHandle, uint32_t now)
+{
+    for (int i = 0; i < EUBX_MAX_PENDING_REQUESTS; i++)
+    {
+        struct eubx_request *request = &pHandle->requests[i];
+
+        if (request->in_use && request->queued)
+        {
+            request->send_time = now;
+            request->queued = false;
+        }
+    }
+}
+
+/*
+ * A poll that is due but still in flight or waiting for a free slot is not a deadline of
+ * its own, it is sent again once a request completes or times out.
+ */
+uint32_t eubx_drv_request_time_to_deadline(struct eubx_handle *pHandle, uint32_t now)
+{
+    uint32_t remaining_us = EUBX_NO_DEADLINE;
+
+    for (int i = 0; i < EUBX_POLL_SCHEDULE_SIZE; i++)
+    {
+        struct eubx_poll_entry *entry = &pHandle->poll_schedule[i];
+        int32_t until_us = (int32_t)(entry->next_time - now);
+
+        if ((0 < entry->interval_ms) && (0 < until_us) && ((uint32_t)until_us < remaining_us))
+        {
+            remaining_us = until_us;
+        }
+        else if ((0 < entry->interval_ms) && (0 >= until_us) && (EUBX_MAX_PENDING_REQUESTS > pHandle->pending_requests) &&
+                 (NULL == find_request(pHandle, entry->message_class, entry->message_id)))
+        {
+            remaining_us = 0;
+        }
+    }
+
+    for (int i = 0; i < EUBX_MAX_PENDING_REQUESTS; i++)
+    {
+        struct eubx_request *request = &pHandle->requests[i];
+        uint32_t elapsed_us = now - request->send_time;
+
+        if (request->in_use)
+        {
+            uint32_t until_us = (elapsed_us < request->timeout_ms * 1000) ? request->timeout_ms * 1000 - elapsed_us : 0;
+
+            if (until_us < remaining_us)
+            {
+                remaining_us = until_us;
+            }
+        }
+    }
+
+    return remaining_us;
+}
+
+void eubx_drv_request_check_timeouts(struct eubx_handle *pHandle)
+{
+    if ((0 < pHandle->pending_requests) && (NULL != pHandle->get_time))
+    {
+        uint32_t now = read_time(pHandle);
+
+        for (int i = 0; i < EUBX_MAX_PENDING_REQUESTS; i++)
+        {
+            struct eubx_request *request = &pHandle->requests[i];
+
+            if (request->in_use && (now - request->send_time >= request->timeout_ms * 1000))
+            {
+                complete_request(pHandle, request, EUBX_ERROR_TIMEOUT);
+            }
+        }
+    }
+}
+
+struct eubx_request *find_request(struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id)
+{
+    struct eubx_request *oldest = NULL;
+
+    // the receiver answers in order, so the oldest matching request gets the response
+    for (int i = 0; i < EUBX_MAX_PENDING_REQUESTS; i++)
+    {
+        struct eubx_request *request = &pHandle->requests[i];
+
+        if (request->in_use && (message_class == request->message_class) && (message_id == request->message_id))
+        {
+            if ((NULL == oldest) || ((int16_t)(request->sequence - oldest->sequence) < 0))
+            {
+                oldest = request;
+            }
+        }
+    }
+
+    return oldest;
+}
+
+void complete_request(struct eubx_handle *pHandle, struct eubx_request *request, TEasyUBXError result)
+{
+    eubx_request_done done = request->done;
+    void *usr_ptr = request->usr_ptr;
+
+    if ((EUBX_ERROR_OK == result) && (NULL != pHandle->get_time))
+    {
+        eubx_record_rtt(pHandle, request->message_class, request->message_id, read_time(pHandle) - request->send_time);
+    }
+
+    if (EUBX_ERROR_TIMEOUT == result)
+    {
+        EUBX_DRV_STATS_COUNT(pHandle, timeouts);
+    }
+
+    if ((EUBX_ERROR_OK != result) && (EUBX_ERROR_OK == pHandle->request_error))
+    {
+        pHandle->request_error = result;
+    }
+
+    // the slot is free before the callback runs, so it can issue the next request
+    request->in_use = false;
+    pHandle->pending_requests--;
+
+    if (NULL != done)
+    {
+        done(usr_ptr, request->message_class, request->message_id, result);
+    }
+}
+
+uint32_t read_time(struct eubx_handle *pHandle)
+{
+    return pHandle->get_time(pHandle->callback_usr_ptr);
+}
@@ -0,0 +1,50 @@
+/*
+ * include file for the Easy UBX C library for pipelined requests
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef EASYUBX_DRV_REQUEST_H
+#define EASYUBX_DRV_REQUEST_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    void eubx_drv_request_reset(struct eubx_handle *pHandle);
+    void eubx_drv_request_handle_message(struct eubx_handle *pHandle);
+    void eubx_drv_request_handle_ack(struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id, bool acknowledged);
+    void eubx_drv_request_check_timeouts(struct eubx_handle *pHandle);
+    void eubx_drv_request_run_schedule(struct eubx_handle *pHandle);
+    void eubx_drv_request_mark_sent(struct eubx_handle *pHandle, uint32_t now); // after the TX queue was flushed
+    uint32_t eubx_drv_request_time_to_deadline(struct eubx_handle *pHandle, uint32_t now); // us, EUBX_NO_DEADLINE if nothing is due
+    TEasyUBXError eubx_drv_request_poll_within(struct eubx_handle *pHandle, uint8_t message_class, uint8_t message_id, uint32_t timeout_ms, eubx_request_done done, void *usr_ptr);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* EASYUBX_DRV_REQUEST_H */
@@ -0,0 +1,86 @@
+/*
+ * source file for the Easy UBX C library for the sec functions
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <string.h>
+
+#include "easyubx_drv.h"
+#include "easyubx_drv_consts.h"
+#include "easyubx_drv_sec.h"
+
+static void handle_receive_sec_uniqid(struct eubx_handle *pHandle);
+
+static const eubx_drv_handler sec_handlers[] = {
+    [EUBX_ID_SEC_UNIQID] = handle_receive_sec_uniqid,
+};
+
+static const struct eubx_drv_length sec_lengths[] = {
+    [EUBX_ID_SEC_UNIQID] = {EUBX_LENGTH_SEC_UNIQID_MIN, EUBX_LENGTH_SEC_UNIQID},
+};
+
+const struct eubx_drv_dispatch eubx_drv_sec_dispatch = EUBX_DRV_DISPATCH_CHECKED(sec_handlers, sec_lengths);
+
+TEasyUBXError eubx_poll_sec_uniqid(struct eubx_handle *pHandle)
+{
+    TEasyUBXError rc = EUBX_ERROR_OK;
+
+    pHandle->send_message.message_class = EUBX_CLASS_SEC;
+    pHandle->send_message.message_id = EUBX_ID_SEC_UNIQID;
+    pHandle->send_message.message_length = 0;
+
+    rc = eubx_send_message(pHandle);
+
+    if (EUBX_ERROR_OK == rc)
+    {
+        rc = eubx_waitfor_event(pHandle, EUBXReceivedSecUNIQID);
+    }
+
+    return rc;
+}
+
+void handle_receive_sec_uniqid(struct eubx_handle *pHandle)
+{
+    if (EUBX_LENGTH_SEC_UNIQID_MIN > pHandle->receive_message.message_length)
+    {
+        pHandle->last_error = EUBX_ERROR_LENGTH;
+    }
+    else
+    {
+        uint16_t length = pHandle->receive_message.message_length - 4;
+
+        // u-blox 9 and later send six id bytes
+        if (EUBX_UNIQUE_ID_LENGTH < length)
+        {
+            length = EUBX_UNIQUE_ID_LENGTH;
+        }
+
+        memcpy(pHandle->receiver_info.unique_id, &pHandle->receive_message.message_buffer[4], length);
+        pHandle->receiver_info.unique_id_length = length;
+
+        eubx_send_notification(pHandle, EUBXReceivedSecUNIQID);
+    }
+}
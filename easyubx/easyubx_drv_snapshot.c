@@ -0,0 +1,75 @@
+/*
+ * source file for the Easy UBX C library for the navigation snapshot
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <string.h>
+
+#include "easyubx_drv.h"
+#include "easyubx_drv_snapshot.h"
+
+uint32_t eubx_read_nav_snapshot(const struct eubx_handle *pHandle, struct eubx_nav_epoch *epoch)
+{
+#if EUBX_NAV_SNAPSHOT_ENABLED
+    uint32_t sequence = 0;
+
+    // the copy selected by the counter is not written until the counter moves on
+    do
+    {
+        sequence = __atomic_load_n(&pHandle->nav_sequence, __ATOMIC_ACQUIRE);
+        memcpy(epoch, &pHandle->nav_snapshots[sequence & 1], sizeof(*epoch));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while (sequence != __atomic_load_n(&pHandle->nav_sequence, __ATOMIC_RELAXED));
+#else
+    memset(epoch, 0, sizeof(*epoch));
+#endif
+
+    return epoch->number;
+}
+
+void eubx_drv_snapshot_reset(struct eubx_handle *pHandle)
+{
+#if EUBX_NAV_SNAPSHOT_ENABLED
+    pHandle->nav_sequence = 0;
+    memset(pHandle->nav_snapshots, 0, sizeof(pHandle->nav_snapshots));
+#endif
+}
+
+void eubx_drv_snapshot_publish(struct eubx_handle *pHandle)
+{
+#if EUBX_NAV_SNAPSHOT_ENABLED
+    uint32_t sequence = pHandle->nav_sequence;
+
+    // the odd step sends readers to copy 1 while copy 0 is written, the even one back to copy 0
+    for (int i = 0; i < 2; i++)
+    {
+        __atomic_store_n(&pHandle->nav_sequence, ++sequence, __ATOMIC_RELEASE);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+
+        memcpy(&pHandle->nav_snapshots[i], &pHandle->nav_epoch, sizeof(pHandle->nav_epoch));
+    }
+#endif
+}
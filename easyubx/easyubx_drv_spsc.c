@@ -0,0 +1,160 @@
+/*
+ * source file for the Easy UBX C library for the single producer single consumer byte ring
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <string.h>
+
+#include "easyubx_drv.h"
+#include "easyubx_drv_spsc.h"
+
+TEasyUBXError eubx_spsc_init(struct eubx_spsc_ring *ring, uint8_t *buffer, uint32_t size)
+{
+    TEasyUBXError rc = EUBX_ERROR_NULLPTR;
+
+    if ((NULL != ring) && (NULL != buffer))
+    {
+        rc = ((0 < size) && (0 == (size & (size - 1)))) ? EUBX_ERROR_OK : EUBX_ERROR_LENGTH;
+    }
+
+    if (EUBX_ERROR_OK == rc)
+    {
+        ring->buffer = buffer;
+        ring->size = size;
+        ring->head = 0;
+        ring->high_water = 0;
+        ring->tail = 0;
+    }
+
+    return rc;
+}
+
+uint32_t eubx_spsc_write_region(struct eubx_spsc_ring *ring, uint8_t **region)
+{
+    uint32_t head = ring->head;
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST);
+    uint32_t offset = head & (ring->size - 1);
+    uint32_t count = ring->size - (head - tail);
+
+    // only up to the end of the buffer, the rest follows with the next region
+    if (ring->size - offset < count)
+    {
+        count = ring->size - offset;
+    }
+
+    *region = &ring->buffer[offset];
+
+    return count;
+}
+
+void eubx_spsc_commit(struct eubx_spsc_ring *ring, uint32_t count)
+{
+    uint32_t head = ring->head + count;
+    uint32_t used = head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    // publishes the bytes written into the region
+    __atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+
+    if (used > __atomic_load_n(&ring->high_water, __ATOMIC_RELAXED))
+    {
+        __atomic_store_n(&ring->high_water, used, __ATOMIC_RELAXED);
+    }
+}
+
+uint32_t eubx_spsc_write(struct eubx_spsc_ring *ring, const uint8_t *buffer, uint32_t length)
+{
+    uint32_t written = 0;
+    uint32_t count = 0;
+    uint8_t *region = NULL;
+
+    while ((written < length) && (0 < (count = eubx_spsc_write_region(ring, &region))))
+    {
+        if (length - written < count)
+        {
+            count = length - written;
+        }
+
+        memcpy(region, &buffer[written], count);
+        eubx_spsc_commit(ring, count);
+        written += count;
+    }
+
+    return written;
+}
+
+uint32_t eubx_spsc_read_region(struct eubx_spsc_ring *ring, const uint8_t **region)
+{
+    uint32_t tail = ring->tail;
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint32_t offset = tail & (ring->size - 1);
+    uint32_t count = head - tail;
+
+    if (ring->size - offset < count)
+    {
+        count = ring->size - offset;
+    }
+
+    *region = &ring->buffer[offset];
+
+    return count;
+}
+
+void eubx_spsc_consume(struct eubx_spsc_ring *ring, uint32_t count)
+{
+    // sequentially consistent so a producer checking for space before it sleeps sees it
+    __atomic_store_n(&ring->tail, ring->tail + count, __ATOMIC_SEQ_CST);
+}
+
+uint32_t eubx_spsc_read(struct eubx_spsc_ring *ring, uint8_t *buffer, uint32_t length)
+{
+    uint32_t read = 0;
+    uint32_t count = 0;
+    const uint8_t *region = NULL;
+
+    while ((read < length) && (0 < (count = eubx_spsc_read_region(ring, &region))))
+    {
+        if (length - read < count)
+        {
+            count = length - read;
+        }
+
+        memcpy(&buffer[read], region, count);
+        eubx_spsc_consume(ring, count);
+        read += count;
+    }
+
+    return read;
+}
+
+uint32_t eubx_spsc_used(const struct eubx_spsc_ring *ring)
+{
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
+
+uint32_t eubx_spsc_high_water(const struct eubx_spsc_ring *ring)
+{
+    return __atomic_load_n(&ring->high_water, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,73 @@
+/*
+ * include file for the Easy UBX C library for the single producer single consumer byte ring
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef EASYUBX_DRV_SPSC_H
+#define EASYUBX_DRV_SPSC_H
+
+#include "easyubx_drv.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /*
+     * Lock free byte ring for exactly one producer and one consumer, e.g. a reader thread or
+     * an UART interrupt feeding the parser. Both sides work on contiguous regions so data can
+     * be read into and parsed out of the ring without extra copies. The indexes run freely
+     * and are masked on access, the size has to be a power of two.
+     */
+    struct eubx_spsc_ring
+    {
+        uint8_t *buffer;
+        uint32_t size;
+        uint32_t head EUBX_CACHE_ALIGNED; // written by the producer only
+        uint32_t high_water;              // largest fill level seen by the producer
+        uint32_t tail EUBX_CACHE_ALIGNED; // written by the consumer only
+    };
+
+    TEasyUBXError eubx_spsc_init(struct eubx_spsc_ring *ring, uint8_t *buffer, uint32_t size);
+
+    // producer side
+    uint32_t eubx_spsc_write_region(struct eubx_spsc_ring *ring, uint8_t **region);
+    void eubx_spsc_commit(struct eubx_spsc_ring *ring, uint32_t count);
+    uint32_t eubx_spsc_write(struct eubx_spsc_ring *ring, const uint8_t *buffer, uint32_t length);
+
+    // consumer side
+    uint32_t eubx_spsc_read_region(struct eubx_spsc_ring *ring, const uint8_t **region);
+    void eubx_spsc_consume(struct eubx_spsc_ring *ring, uint32_t count);
+    uint32_t eubx_spsc_read(struct eubx_spsc_ring *ring, uint8_t *buffer, uint32_t length);
+
+    uint32_t eubx_spsc_used(const struct eubx_spsc_ring *ring);
+    uint32_t eubx_spsc_high_water(const struct eubx_spsc_ring *ring);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* EASYUBX_DRV_SPSC_H */
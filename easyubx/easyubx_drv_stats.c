@@ -0,0 +1,173 @@
+/*
+ * source file for the Easy UBX C library for the hot path statistics
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <stddef.h>
+#include <string.h>
+
+#include "easyubx_drv.h"
+#include "easyubx_drv_stats.h"
+
+// the plain counters are laid out one after the other in front of the message table
+#define STATS_COUNTERS (offsetof(struct eubx_stats, messages) / sizeof(uint32_t))
+
+static uint8_t message_hash(uint8_t message_class, uint8_t message_id);
+static uint8_t histogram_bucket(uint32_t value_us);
+
+void eubx_get_stats(const struct eubx_handle *pHandle, struct eubx_stats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+
+#if EUBX_STATS_ENABLED
+    const uint32_t *counters = &pHandle->stats.bytes_in;
+    uint32_t *copy = &stats->bytes_in;
+
+    for (size_t i = 0; i < STATS_COUNTERS; i++)
+    {
+        copy[i] = __atomic_load_n(&counters[i], __ATOMIC_RELAXED);
+    }
+
+    for (int i = 0; i < EUBX_STATS_MESSAGE_TABLE_SIZE; i++)
+    {
+        const struct eubx_stats_message *entry = &pHandle->stats.messages[i];
+
+        // class and id are written before the entry is published
+        if (__atomic_load_n(&entry->in_use, __ATOMIC_ACQUIRE))
+        {
+            stats->messages[i].in_use = true;
+            stats->messages[i].message_class = entry->message_class;
+            stats->messages[i].message_id = entry->message_id;
+            stats->messages[i].frames = __atomic_load_n(&entry->frames, __ATOMIC_RELAXED);
+        }
+    }
+
+    for (int i = 0; i < EUBX_STATS_HISTOGRAM_BUCKETS; i++)
+    {
+        stats->callback_latency[i] = __atomic_load_n(&pHandle->stats.callback_latency[i], __ATOMIC_RELAXED);
+        stats->rtt[i] = __atomic_load_n(&pHandle->stats.rtt[i], __ATOMIC_RELAXED);
+    }
+#endif
+}
+
+uint32_t eubx_stats_percentile(const uint32_t *histogram, uint8_t percent)
+{
+    uint64_t total = 0;
+    uint64_t sum = 0;
+    uint32_t bound = 0;
+
+    for (int i = 0; i < EUBX_STATS_HISTOGRAM_BUCKETS; i++)
+    {
+        total += histogram[i];
+    }
+
+    for (int i = 0; (i < EUBX_STATS_HISTOGRAM_BUCKETS) && (0 < total); i++)
+    {
+        sum += histogram[i];
+        bound = (EUBX_STATS_HISTOGRAM_BUCKETS - 1 > i) ? ((uint32_t)2 << i) : UINT32_MAX;
+
+        if (sum * 100 >= total * percent)
+        {
+            break;
+        }
+    }
+
+    return bound;
+}
+
+void eubx_drv_stats_reset(struct eubx_handle *pHandle)
+{
+#if EUBX_STATS_ENABLED
+    memset(&pHandle->stats, 0, sizeof(pHandle->stats));
+#endif
+}
+
+void eubx_drv_stats_frame(struct eubx_handle *pHandle)
+{
+#if EUBX_STATS_ENABLED
+    uint8_t message_class = pHandle->receive_message.message_class;
+    uint8_t message_id = pHandle->receive_message.message_id;
+    uint8_t slot = message_hash(message_class, message_id);
+    struct eubx_stats_message *found = NULL;
+
+    eubx_drv_stats_add(&pHandle->stats.frames, 1);
+
+    // open addressing with linear probing, entries are never removed
+    for (int i = 0; i < EUBX_STATS_MESSAGE_TABLE_SIZE; i++)
+    {
+        struct eubx_stats_message *entry = &pHandle->stats.messages[(slot + i) % EUBX_STATS_MESSAGE_TABLE_SIZE];
+
+        if (!entry->in_use)
+        {
+            entry->message_class = message_class;
+            entry->message_id = message_id;
+            __atomic_store_n(&entry->in_use, true, __ATOMIC_RELEASE);
+            found = entry;
+            break;
+        }
+
+        if ((message_class == entry->message_class) && (message_id == entry->message_id))
+        {
+            found = entry;
+            break;
+        }
+    }
+
+    eubx_drv_stats_add((NULL != found) ? &found->frames : &pHandle->stats.frames_other, 1);
+
+    if (NULL != pHandle->get_time)
+    {
+        eubx_drv_stats_sample(pHandle->stats.callback_latency, pHandle->get_time(pHandle->callback_usr_ptr) - pHandle->receive_timestamp);
+    }
+#endif
+}
+
+void eubx_drv_stats_sample(uint32_t *histogram, uint32_t value_us)
+{
+    eubx_drv_stats_add(&histogram[histogram_bucket(value_us)], 1);
+}
+
+uint8_t message_hash(uint8_t message_class, uint8_t message_id)
+{
+    return (uint8_t)((message_class * 31 + message_id) % EUBX_STATS_MESSAGE_TABLE_SIZE);
+}
+
+uint8_t histogram_bucket(uint32_t value_us)
+{
+    uint8_t bucket = 0;
+
+    // index of the highest bit set
+#if defined(__GNUC__)
+    bucket = (1 < value_us) ? (uint8_t)(31 - __builtin_clz(value_us)) : 0;
+#else
+    while (1 < (value_us >> bucket))
+    {
+        bucket++;
+    }
+#endif
+
+    return (EUBX_STATS_HISTOGRAM_BUCKETS > bucket) ? bucket : EUBX_STATS_HISTOGRAM_BUCKETS - 1;
+}
@@ -0,0 +1,65 @@
+/*
+ * include file for the Easy UBX C library for the hot path statistics
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef EASYUBX_DRV_STATS_H
+#define EASYUBX_DRV_STATS_H
+
+#include "easyubx_drv.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#if EUBX_STATS_ENABLED
+#define EUBX_DRV_STATS_COUNT(pHandle, counter) eubx_drv_stats_add(&(pHandle)->stats.counter, 1)
+#define EUBX_DRV_STATS_ADD(pHandle, counter, value) eubx_drv_stats_add(&(pHandle)->stats.counter, value)
+#define EUBX_DRV_STATS_FRAME(pHandle) eubx_drv_stats_frame(pHandle)
+#define EUBX_DRV_STATS_RTT(pHandle, rtt_us) eubx_drv_stats_sample((pHandle)->stats.rtt, rtt_us)
+#else
+#define EUBX_DRV_STATS_COUNT(pHandle, counter)
+#define EUBX_DRV_STATS_ADD(pHandle, counter, value)
+#define EUBX_DRV_STATS_FRAME(pHandle)
+#define EUBX_DRV_STATS_RTT(pHandle, rtt_us)
+#endif
+
+    // the parser is the only writer, a plain increment published with an atomic store is enough
+    static inline void eubx_drv_stats_add(uint32_t *counter, uint32_t value)
+    {
+        __atomic_store_n(counter, *counter + value, __ATOMIC_RELAXED);
+    }
+
+    void eubx_drv_stats_reset(struct eubx_handle *pHandle);
+    void eubx_drv_stats_frame(struct eubx_handle *pHandle);
+    void eubx_drv_stats_sample(uint32_t *histogram, uint32_t value_us);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* EASYUBX_DRV_STATS_H */
@@ -0,0 +1,102 @@
+/*
+ * include file for the Easy UBX C library for helpers shared by the message modules
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef EASYUBX_DRV_UTIL_H
+#define EASYUBX_DRV_UTIL_H
+
+#include <stdint.h>
+
+#include "easyubx_drv.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // little endian loads from unaligned payload positions, independent of the host byte order
+
+    static inline uint16_t eubx_drv_load_u16(const uint8_t *buffer)
+    {
+        return (uint16_t)(buffer[0] | (buffer[1] << 8));
+    }
+
+    static inline uint32_t eubx_drv_load_u32(const uint8_t *buffer)
+    {
+        return (uint32_t)buffer[0] | ((uint32_t)buffer[1] << 8) | ((uint32_t)buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
+    }
+
+    static inline int16_t eubx_drv_load_i16(const uint8_t *buffer)
+    {
+        return (int16_t)eubx_drv_load_u16(buffer);
+    }
+
+    static inline int32_t eubx_drv_load_i32(const uint8_t *buffer)
+    {
+        return (int32_t)eubx_drv_load_u32(buffer);
+    }
+
+    static inline void eubx_drv_store_u16(uint8_t *buffer, uint16_t value)
+    {
+        buffer[0] = (uint8_t)value;
+        buffer[1] = (uint8_t)(value >> 8);
+    }
+
+    static inline void eubx_drv_store_u32(uint8_t *buffer, uint32_t value)
+    {
+        buffer[0] = (uint8_t)value;
+        buffer[1] = (uint8_t)(value >> 8);
+        buffer[2] = (uint8_t)(value >> 16);
+        buffer[3] = (uint8_t)(value >> 24);
+    }
+
+    typedef void (*eubx_drv_handler)(struct eubx_handle *pHandle);
+
+    // payload lengths a receiver sends for one message, {0, 0} for messages that are not checked
+    struct eubx_drv_length
+    {
+        uint16_t min;
+        uint16_t max;
+    };
+
+    // built in decoders of one class and their expected lengths, both indexed by message id
+    struct eubx_drv_dispatch
+    {
+        const eubx_drv_handler *handlers;
+        uint8_t count;
+        const struct eubx_drv_length *lengths;
+        uint8_t length_count;
+    };
+
+#define EUBX_DRV_DISPATCH(table) {table, sizeof(table) / sizeof(table[0]), NULL, 0}
+#define EUBX_DRV_DISPATCH_CHECKED(table, lengths) {table, sizeof(table) / sizeof(table[0]), lengths, sizeof(lengths) / sizeof(lengths[0])}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* EASYUBX_DRV_UTIL_H */
@@ -0,0 +1,322 @@
+/*
+ * Warm start of the Easy UBX C library from a saved receiver state
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <string.h>
+
+#include "easyubx_drv.h"
+#include "easyubx_drv_consts.h"
+#include "easyubx_drv_util.h"
+#include "easyubx_drv_warm.h"
+
+#define EUBX_WARM_MAGIC "EUWS"
+#define EUBX_WARM_VERSION 1
+
+/*
+ * The state is receiver_info and receiver_config in a fixed little endian layout,
+ * so a file written on one host can be read on another:
+ *
+ *   magic, version, unique id length and id, software version, chipset version,
+ *   platform model, fix mode, measurement rate, navigation rate, time reference,
+ *   CFG-PRT fields, CFG-GNSS header and all block slots, UBX checksum of the rest
+ */
+struct eubx_warm_cursor
+{
+    uint8_t *output;
+    const uint8_t *input;
+    uint16_t position;
+};
+
+static void put_u8(struct eubx_warm_cursor *cursor, uint8_t value);
+static void put_u16(struct eubx_warm_cursor *cursor, uint16_t value);
+static void put_u32(struct eubx_warm_cursor *cursor, uint32_t value);
+static void put_bytes(struct eubx_warm_cursor *cursor, const void *bytes, uint16_t length);
+static uint8_t get_u8(struct eubx_warm_cursor *cursor);
+static uint16_t get_u16(struct eubx_warm_cursor *cursor);
+static uint32_t get_u32(struct eubx_warm_cursor *cursor);
+static void get_bytes(struct eubx_warm_cursor *cursor, void *bytes, uint16_t length);
+
+static void warm_request_done(void *usr_ptr, uint8_t message_class, uint8_t message_id, TEasyUBXError result);
+static void drop_warm_state(struct eubx_handle *pHandle);
+
+uint16_t eubx_save_warm_state(const struct eubx_handle *pHandle, uint8_t *buffer, uint16_t size)
+{
+    struct eubx_warm_cursor cursor = {buffer, NULL, 0};
+    const struct eubx_receiver_info *info = &pHandle->receiver_info;
+    const struct eubx_receiver_config *config = &pHandle->receiver_config;
+    uint8_t ck_a = 0;
+    uint8_t ck_b = 0;
+
+    // without the firmware string a restored state could never be verified
+    if ((EUBX_WARM_STATE_SIZE <= size) && (0 != info->software_version[0]))
+    {
+        put_bytes(&cursor, EUBX_WARM_MAGIC, 4);
+        put_u8(&cursor, EUBX_WARM_VERSION);
+        put_u8(&cursor, info->unique_id_length);
+        put_bytes(&cursor, info->unique_id, EUBX_UNIQUE_ID_LENGTH);
+        put_bytes(&cursor, info->software_version, EUBX_SW_VERSION_LENGTH);
+        put_u16(&cursor, (uint16_t)info->chipset_version);
+
+        put_u8(&cursor, (uint8_t)config->dynamic_platform_model);
+        put_u8(&cursor, (uint8_t)config->fix_mode);
+        put_u16(&cursor, config->measurement_rate);
+        put_u16(&cursor, config->navigation_rate);
+        put_u16(&cursor, config->rate_time_reference);
+
+        put_u8(&cursor, config->port.port_id);
+        put_u16(&cursor, config->port.tx_ready);
+        put_u32(&cursor, config->port.mode);
+        put_u32(&cursor, config->port.baud_rate);
+        put_u16(&cursor, config->port.in_proto_mask);
+        put_u16(&cursor, config->port.out_proto_mask);
+        put_u16(&cursor, config->port.flags);
+
+        put_u8(&cursor, config->gnss.hw_channels);
+        put_u8(&cursor, config->gnss.used_channels);
+        put_u8(&cursor, config->gnss.block_count);
+
+        for (uint8_t i = 0; i < EUBX_GNSS_BLOCK_COUNT; i++)
+        {
+            put_u8(&cursor, config->gnss.blocks[i].gnss_id);
+            put_u8(&cursor, config->gnss.blocks[i].reserved_channels);
+            put_u8(&cursor, config->gnss.blocks[i].max_channels);
+            put_u32(&cursor, config->gnss.blocks[i].flags);
+        }
+
+        eubx_checksum_update(&ck_a, &ck_b, buffer, cursor.position);
+        put_u8(&cursor, ck_a);
+        put_u8(&cursor, ck_b);
+    }
+
+    return cursor.position;
+}
+
+bool eubx_drv_warm_restore(struct eubx_handle *pHandle, const uint8_t *state, uint16_t length)
+{
+    struct eubx_warm_cursor cursor = {NULL, state, 0};
+    struct eubx_receiver_info info;
+    struct eubx_receiver_config config;
+    bool valid = (NULL != state) && (EUBX_WARM_STATE_SIZE == length);
+    uint8_t ck_a = 0;
+    uint8_t ck_b = 0;
+
+    if (valid)
+    {
+        eubx_checksum_update(&ck_a, &ck_b, state, EUBX_WARM_STATE_SIZE - 2);
+        valid = (0 == memcmp(state, EUBX_WARM_MAGIC, 4)) && (EUBX_WARM_VERSION == state[4]) && (ck_a == state[EUBX_WARM_STATE_SIZE - 2]) && (ck_b == state[EUBX_WARM_STATE_SIZE - 1]);
+    }
+
+    if (valid)
+    {
+        cursor.position = 5;
+        info.unique_id_length = get_u8(&cursor);
+        get_bytes(&cursor, info.unique_id, EUBX_UNIQUE_ID_LENGTH);
+        get_bytes(&cursor, info.software_version, EUBX_SW_VERSION_LENGTH);
+        info.chipset_version = (TEasyUBXChipsetVersion)(int16_t)get_u16(&cursor);
+
+        config.dynamic_platform_model = (TEasyUBXDynamicPlatformModel)(int8_t)get_u8(&cursor);
+        config.fix_mode = (TEasyUBXFixMode)(int8_t)get_u8(&cursor);
+        config.measurement_rate = get_u16(&cursor);
+        config.navigation_rate = get_u16(&cursor);
+        config.rate_time_reference = get_u16(&cursor);
+
+        config.port.port_id = get_u8(&cursor);
+        config.port.tx_ready = get_u16(&cursor);
+        config.port.mode = get_u32(&cursor);
+        config.port.baud_rate = get_u32(&cursor);
+        config.port.in_proto_mask = get_u16(&cursor);
+        config.port.out_proto_mask = get_u16(&cursor);
+        config.port.flags = get_u16(&cursor);
+
+        config.gnss.hw_channels = get_u8(&cursor);
+        config.gnss.used_channels = get_u8(&cursor);
+        config.gnss.block_count = get_u8(&cursor);
+
+        for (uint8_t i = 0; i < EUBX_GNSS_BLOCK_COUNT; i++)
+        {
+            config.gnss.blocks[i].gnss_id = get_u8(&cursor);
+            config.gnss.blocks[i].reserved_channels = get_u8(&cursor);
+            config.gnss.blocks[i].max_channels = get_u8(&cursor);
+            config.gnss.blocks[i].flags = get_u32(&cursor);
+        }
+
+        valid = (EUBX_UNIQUE_ID_LENGTH >= info.unique_id_length) && (0 != info.software_version[0]) &&
+                (0 == info.software_version[EUBX_SW_VERSION_LENGTH - 1]) && (EUBX_GNSS_BLOCK_COUNT >= config.gnss.block_count);
+    }
+
+    if (valid)
+    {
+        pHandle->receiver_info = info;
+        pHandle->receiver_config = config;
+        pHandle->warm_key = info;
+    }
+
+    return valid;
+}
+
+/*
+ * Polls the firmware string and, if the state has one, the chip id without waiting for
+ * them. The cached state stays in use until an answer differs or a poll fails, then it
+ * is dropped and the configuration is polled again.
+ */
+TEasyUBXError eubx_drv_warm_verify(struct eubx_handle *pHandle)
+{
+    TEasyUBXError rc = EUBX_ERROR_OK;
+
+    pHandle->warm_status = EUBXWarmVerifying;
+    pHandle->warm_pending = 0;
+
+    rc = eubx_request_poll(pHandle, EUBX_CLASS_MON, EUBX_ID_MON_VER, warm_request_done, pHandle);
+
+    if (EUBX_ERROR_OK == rc)
+    {
+        pHandle->warm_pending++;
+    }
+
+    // u-blox 7 and older have no SEC-UNIQID
+    if ((EUBX_ERROR_OK == rc) && (0 < pHandle->warm_key.unique_id_length))
+    {
+        rc = eubx_request_poll(pHandle, EUBX_CLASS_SEC, EUBX_ID_SEC_UNIQID, warm_request_done, pHandle);
+
+        if (EUBX_ERROR_OK == rc)
+        {
+            pHandle->warm_pending++;
+        }
+    }
+
+    return rc;
+}
+
+void warm_request_done(void *usr_ptr, uint8_t message_class, uint8_t message_id, TEasyUBXError result)
+{
+    struct eubx_handle *pHandle = (struct eubx_handle *)usr_ptr;
+    const struct eubx_receiver_info *info = &pHandle->receiver_info;
+    const struct eubx_receiver_info *key = &pHandle->warm_key;
+    bool match = (EUBX_ERROR_OK == result);
+
+    if (match && (EUBX_CLASS_SEC == message_class))
+    {
+        match = (key->unique_id_length == info->unique_id_length) && (0 == memcmp(key->unique_id, info->unique_id, key->unique_id_length));
+    }
+    else if (match)
+    {
+        match = (key->chipset_version == info->chipset_version) && (0 == strncmp(key->software_version, info->software_version, EUBX_SW_VERSION_LENGTH));
+    }
+
+    pHandle->warm_pending--;
+
+    if (EUBXWarmVerifying == pHandle->warm_status)
+    {
+        if (!match)
+        {
+            drop_warm_state(pHandle);
+        }
+        else if (0 == pHandle->warm_pending)
+        {
+            pHandle->warm_status = EUBXWarmVerified;
+            eubx_send_notification(pHandle, EUBXWarmStartVerified);
+        }
+    }
+}
+
+// the answers refill the state in the background, like the polls of a cold init would
+void drop_warm_state(struct eubx_handle *pHandle)
+{
+    pHandle->warm_status = EUBXWarmMismatch;
+
+    pHandle->receiver_info.chipset_version = EUBXChipsetNotSet;
+    pHandle->receiver_info.software_version[0] = 0;
+    pHandle->receiver_info.unique_id_length = 0;
+
+    memset(&pHandle->receiver_config, 0, sizeof(pHandle->receiver_config));
+    pHandle->receiver_config.dynamic_platform_model = EUBXPlatformModelNotSet;
+    pHandle->receiver_config.fix_mode = EUBXFixModeNotSet;
+
+    eubx_request_poll(pHandle, EUBX_CLASS_MON, EUBX_ID_MON_VER, NULL, NULL);
+    eubx_request_poll(pHandle, EUBX_CLASS_CFG, EUBX_ID_CFG_NAV5, NULL, NULL);
+    eubx_request_poll(pHandle, EUBX_CLASS_CFG, EUBX_ID_CFG_RATE, NULL, NULL);
+    eubx_request_poll(pHandle, EUBX_CLASS_CFG, EUBX_ID_CFG_PRT, NULL, NULL);
+
+    if (0 < pHandle->warm_key.unique_id_length)
+    {
+        eubx_request_poll(pHandle, EUBX_CLASS_SEC, EUBX_ID_SEC_UNIQID, NULL, NULL);
+    }
+
+    eubx_send_notification(pHandle, EUBXWarmStartMismatch);
+}
+
+void put_u8(struct eubx_warm_cursor *cursor, uint8_t value)
+{
+    cursor->output[cursor->position++] = value;
+}
+
+void put_u16(struct eubx_warm_cursor *cursor, uint16_t value)
+{
+    eubx_drv_store_u16(&cursor->output[cursor->position], value);
+    cursor->position += 2;
+}
+
+void put_u32(struct eubx_warm_cursor *cursor, uint32_t value)
+{
+    eubx_drv_store_u32(&cursor->output[cursor->position], value);
+    cursor->position += 4;
+}
+
+void put_bytes(struct eubx_warm_cursor *cursor, const void *bytes, uint16_t length)
+{
+    memcpy(&cursor->output[cursor->position], bytes, length);
+    cursor->position += length;
+}
+
+uint8_t get_u8(struct eubx_warm_cursor *cursor)
+{
+    return cursor->input[cursor->position++];
+}
+
+uint16_t get_u16(struct eubx_warm_cursor *cursor)
+{
+    uint16_t value = eubx_drv_load_u16(&cursor->input[cursor->position]);
+
+    cursor->position += 2;
+
+    return value;
+}
+
+uint32_t get_u32(struct eubx_warm_cursor *cursor)
+{
+    uint32_t value = eubx_drv_load_u32(&cursor->input[cursor->position]);
+
+    cursor->position += 4;
+
+    return value;
+}
+
+void get_bytes(struct eubx_warm_cursor *cursor, void *bytes, uint16_t length)
+{
+    memcpy(bytes, &cursor->input[cursor->position], length);
+    cursor->position += length;
+}
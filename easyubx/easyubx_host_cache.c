@@ -0,0 +1,88 @@
+/*
+ * source file for the Easy UBX C library for the warm start cache file
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#if defined(__linux__)
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "easyubx_host_cache.h"
+
+#define EUBX_CACHE_PATH_LENGTH 256
+
+TEasyUBXError eubx_cache_load(const char *path, uint8_t *buffer, uint16_t size, uint16_t *length)
+{
+    TEasyUBXError rc = EUBX_ERROR_NULLPTR;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    *length = 0;
+
+    if (0 <= fd)
+    {
+        ssize_t count = read(fd, buffer, size);
+
+        if (0 < count)
+        {
+            *length = (uint16_t)count;
+            rc = EUBX_ERROR_OK;
+        }
+
+        close(fd);
+    }
+
+    return rc;
+}
+
+TEasyUBXError eubx_cache_store(const char *path, const struct eubx_handle *pHandle)
+{
+    TEasyUBXError rc = EUBX_ERROR_NOT_INITIALIZED;
+    uint8_t state[EUBX_WARM_STATE_SIZE];
+    uint16_t length = eubx_save_warm_state(pHandle, state, sizeof(state));
+    char temporary[EUBX_CACHE_PATH_LENGTH];
+
+    if ((0 < length) && (sizeof(temporary) > (size_t)snprintf(temporary, sizeof(temporary), "%s.tmp", path)))
+    {
+        int fd = open(temporary, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+        rc = EUBX_ERROR_NULLPTR;
+
+        // a reader sees the old or the new file, never a torn one
+        if (0 <= fd)
+        {
+            bool written = (length == write(fd, state, length));
+
+            close(fd);
+            rc = (written && (0 == rename(temporary, path))) ? EUBX_ERROR_OK : EUBX_ERROR_SEND_OVERFLOW;
+        }
+    }
+
+    return rc;
+}
+
+#endif /* __linux__ */
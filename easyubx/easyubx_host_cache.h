@@ -0,0 +1,55 @@
+/*
+ * include file for the Easy UBX C library for the warm start cache file
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef EASYUBX_HOST_CACHE_H
+#define EASYUBX_HOST_CACHE_H
+
+#if defined(__linux__)
+
+#include "easyubx_drv.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /*
+     * Keeps the output of eubx_save_warm_state between runs. The library checks the
+     * content, so the file needs no header of its own; a missing or damaged file just
+     * means a cold init.
+     */
+    TEasyUBXError eubx_cache_load(const char *path, uint8_t *buffer, uint16_t size, uint16_t *length);
+    TEasyUBXError eubx_cache_store(const char *path, const struct eubx_handle *pHandle); // replaces the file atomically
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* __linux__ */
+
+#endif /* EASYUBX_HOST_CACHE_H */
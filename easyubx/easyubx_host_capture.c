@@ -0,0 +1,309 @@
+/*
+ * source file for the Easy UBX C library for binary captures and their replay
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#if defined(__linux__)
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "easyubx_host_capture.h"
+
+static uint64_t monotonic_us(void);
+static uint64_t realtime_us(void);
+static const struct eubx_capture_record *current_record(const struct eubx_replay *replay);
+static void next_record(struct eubx_replay *replay);
+static uint64_t due_in_us(const struct eubx_replay *replay, const struct eubx_capture_record *record);
+
+TEasyUBXError eubx_capture_open(struct eubx_capture_writer *writer, const char *path)
+{
+    TEasyUBXError rc = EUBX_ERROR_NULLPTR;
+    struct eubx_capture_header header;
+
+    writer->file = fopen(path, "wb");
+    writer->start_us = monotonic_us();
+    writer->records = 0;
+
+    if (NULL != writer->file)
+    {
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, EUBX_CAPTURE_MAGIC, sizeof(header.magic));
+        header.version = EUBX_CAPTURE_VERSION;
+        header.byte_order = EUBX_CAPTURE_BYTE_ORDER;
+        header.start_realtime_us = realtime_us();
+
+        rc = (1 == fwrite(&header, sizeof(header), 1, writer->file)) ? EUBX_ERROR_OK : EUBX_ERROR_SEND_OVERFLOW;
+    }
+
+    return rc;
+}
+
+void eubx_capture_close(struct eubx_capture_writer *writer)
+{
+    if (NULL != writer->file)
+    {
+        fclose(writer->file);
+        writer->file = NULL;
+    }
+}
+
+void eubx_capture_tap(void *usr_ptr, TEasyUBXDirection direction, const uint8_t *buffer, size_t length)
+{
+    struct eubx_capture_writer *writer = (struct eubx_capture_writer *)usr_ptr;
+    static const uint8_t padding[EUBX_CAPTURE_ALIGNMENT] = {0};
+    struct eubx_capture_record record;
+
+    if ((NULL != writer->file) && (0 < length))
+    {
+        memset(&record, 0, sizeof(record));
+        record.timestamp_us = monotonic_us() - writer->start_us;
+        record.length = length;
+        record.direction = direction;
+
+        // stdio buffering keeps this at one write per few kilobytes
+        fwrite(&record, sizeof(record), 1, writer->file);
+        fwrite(buffer, 1, length, writer->file);
+        fwrite(padding, 1, (EUBX_CAPTURE_ALIGNMENT - length % EUBX_CAPTURE_ALIGNMENT) % EUBX_CAPTURE_ALIGNMENT, writer->file);
+        writer->records++;
+    }
+}
+
+TEasyUBXError eubx_replay_open(struct eubx_replay *replay, const char *path, bool realtime)
+{
+    TEasyUBXError rc = EUBX_ERROR_NULLPTR;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat info;
+
+    memset(replay, 0, sizeof(*replay));
+    replay->realtime = realtime;
+
+    if ((0 <= fd) && (0 == fstat(fd, &info)) && (sizeof(struct eubx_capture_header) <= (size_t)info.st_size))
+    {
+        void *data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (MAP_FAILED != data)
+        {
+            const struct eubx_capture_header *header = (const struct eubx_capture_header *)data;
+
+            replay->data = (const uint8_t *)data;
+            replay->size = info.st_size;
+            replay->offset = sizeof(struct eubx_capture_header);
+            madvise(data, info.st_size, MADV_SEQUENTIAL);
+
+            if ((0 != memcmp(header->magic, EUBX_CAPTURE_MAGIC, sizeof(header->magic))) || (EUBX_CAPTURE_BYTE_ORDER != header->byte_order))
+            {
+                rc = EUBX_ERROR_NOT_SUPPORTED;
+            }
+            else
+            {
+                rc = (EUBX_CAPTURE_VERSION == header->version) ? EUBX_ERROR_OK : EUBX_ERROR_NOT_SUPPORTED;
+            }
+        }
+    }
+
+    if (0 <= fd)
+    {
+        close(fd);
+    }
+
+    if (EUBX_ERROR_OK != rc)
+    {
+        eubx_replay_close(replay);
+    }
+    else if (NULL != current_record(replay))
+    {
+        replay->first_timestamp_us = current_record(replay)->timestamp_us;
+    }
+
+    replay->start_us = monotonic_us();
+
+    return rc;
+}
+
+void eubx_replay_close(struct eubx_replay *replay)
+{
+    if (NULL != replay->data)
+    {
+        munmap((void *)replay->data, replay->size);
+        replay->data = NULL;
+        replay->size = 0;
+        replay->offset = 0;
+    }
+}
+
+bool eubx_replay_done(const struct eubx_replay *replay)
+{
+    return NULL == current_record(replay);
+}
+
+uint64_t eubx_replay_run(struct eubx_replay *replay, struct eubx_handle *pHandle)
+{
+    uint64_t fed = 0;
+    const struct eubx_capture_record *record = NULL;
+
+    while (NULL != (record = current_record(replay)))
+    {
+        if (EUBXDirectionRx == record->direction)
+        {
+            uint64_t wait_us = due_in_us(replay, record);
+
+            if (0 < wait_us)
+            {
+                usleep(wait_us);
+            }
+
+            // the payload is parsed in place from the mapping
+            eubx_receive_bytes(pHandle, (const uint8_t *)(record + 1) + replay->record_offset, record->length - replay->record_offset);
+            fed += record->length - replay->record_offset;
+            replay->rx_bytes += record->length - replay->record_offset;
+        }
+
+        next_record(replay);
+    }
+
+    return fed;
+}
+
+uint16_t eubx_replay_read(struct eubx_replay *replay, uint8_t *buffer, uint16_t max_length)
+{
+    uint16_t count = 0;
+    const struct eubx_capture_record *record = NULL;
+
+    while ((count < max_length) && (NULL != (record = current_record(replay))))
+    {
+        if (EUBXDirectionTx == record->direction)
+        {
+            next_record(replay);
+        }
+        else if (0 < due_in_us(replay, record))
+        {
+            break;
+        }
+        else
+        {
+            uint32_t available = record->length - replay->record_offset;
+
+            if ((uint32_t)(max_length - count) < available)
+            {
+                available = max_length - count;
+            }
+
+            memcpy(&buffer[count], (const uint8_t *)(record + 1) + replay->record_offset, available);
+            count += available;
+            replay->record_offset += available;
+            replay->rx_bytes += available;
+
+            if (replay->record_offset == record->length)
+            {
+                next_record(replay);
+            }
+        }
+    }
+
+    return count;
+}
+
+void eubx_replay_wait(struct eubx_replay *replay, uint32_t timeout_us)
+{
+    const struct eubx_capture_record *record = current_record(replay);
+
+    // only real time replay has to wait for the recorded arrival of the next bytes
+    if (replay->realtime)
+    {
+        uint64_t wait_us = (NULL != record) ? due_in_us(replay, record) : timeout_us;
+
+        usleep((wait_us < timeout_us) ? wait_us : timeout_us);
+    }
+}
+
+const struct eubx_capture_record *current_record(const struct eubx_replay *replay)
+{
+    const struct eubx_capture_record *record = NULL;
+
+    // a capture cut off while writing ends with the last complete record
+    if ((NULL != replay->data) && (sizeof(struct eubx_capture_record) <= replay->size - replay->offset))
+    {
+        record = (const struct eubx_capture_record *)&replay->data[replay->offset];
+
+        if (record->length > replay->size - replay->offset - sizeof(struct eubx_capture_record))
+        {
+            record = NULL;
+        }
+    }
+
+    return record;
+}
+
+void next_record(struct eubx_replay *replay)
+{
+    const struct eubx_capture_record *record = current_record(replay);
+    size_t length = sizeof(struct eubx_capture_record) + record->length;
+
+    length += (EUBX_CAPTURE_ALIGNMENT - length % EUBX_CAPTURE_ALIGNMENT) % EUBX_CAPTURE_ALIGNMENT;
+
+    replay->offset = (replay->size - replay->offset < length) ? replay->size : replay->offset + length;
+    replay->record_offset = 0;
+}
+
+uint64_t due_in_us(const struct eubx_replay *replay, const struct eubx_capture_record *record)
+{
+    uint64_t due_us = 0;
+
+    if (replay->realtime)
+    {
+        uint64_t elapsed_us = monotonic_us() - replay->start_us;
+        uint64_t offset_us = record->timestamp_us - replay->first_timestamp_us;
+
+        due_us = (offset_us > elapsed_us) ? offset_us - elapsed_us : 0;
+    }
+
+    return due_us;
+}
+
+uint64_t monotonic_us(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec * 1000000ULL + now.tv_nsec / 1000;
+}
+
+uint64_t realtime_us(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    return now.tv_sec * 1000000ULL + now.tv_nsec / 1000;
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,110 @@
+/*
+ * include file for the Easy UBX C library for binary captures and their replay
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef EASYUBX_HOST_CAPTURE_H
+#define EASYUBX_HOST_CAPTURE_H
+
+#if defined(__linux__)
+
+#include <stdio.h>
+
+#include "easyubx_drv.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define EUBX_CAPTURE_MAGIC "EUBXCAP"
+#define EUBX_CAPTURE_VERSION 1
+#define EUBX_CAPTURE_BYTE_ORDER 0x01020304 // reads differently on a host with other endianness
+#define EUBX_CAPTURE_ALIGNMENT 8
+
+    /*
+     * A capture is a header followed by records. Every record carries the monotonic time
+     * since the capture started, the direction and the raw bytes, padded so the next
+     * record is 8 byte aligned again. All fields are in host byte order, so a mapped
+     * file can be walked without any parsing.
+     */
+    struct eubx_capture_header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t byte_order;
+        uint64_t start_realtime_us; // wall clock time the capture started, for reference only
+    };
+
+    struct eubx_capture_record
+    {
+        uint64_t timestamp_us; // monotonic time since the capture started
+        uint32_t length;
+        uint8_t direction;     // TEasyUBXDirection
+        uint8_t reserved[3];
+    };
+
+    struct eubx_capture_writer
+    {
+        FILE *file;
+        uint64_t start_us;
+        uint64_t records;
+    };
+
+    struct eubx_replay
+    {
+        const uint8_t *data; // the mapped file
+        size_t size;
+        size_t offset;          // next record
+        uint32_t record_offset; // bytes of the current receive record already handed out by eubx_replay_read
+        bool realtime;          // keeps the recorded timing instead of replaying as fast as possible
+        uint64_t start_us;
+        uint64_t first_timestamp_us;
+        uint64_t rx_bytes;
+    };
+
+    TEasyUBXError eubx_capture_open(struct eubx_capture_writer *writer, const char *path);
+    void eubx_capture_close(struct eubx_capture_writer *writer);
+    void eubx_capture_tap(void *writer, TEasyUBXDirection direction, const uint8_t *buffer, size_t length); // an eubx_tap
+
+    TEasyUBXError eubx_replay_open(struct eubx_replay *replay, const char *path, bool realtime);
+    void eubx_replay_close(struct eubx_replay *replay);
+    bool eubx_replay_done(const struct eubx_replay *replay);
+
+    // feeds all received bytes straight from the mapping into the handle
+    uint64_t eubx_replay_run(struct eubx_replay *replay, struct eubx_handle *pHandle);
+
+    // transport adapters, a replay can stand in for the serial port of a handle
+    uint16_t eubx_replay_read(struct eubx_replay *replay, uint8_t *buffer, uint16_t max_length);
+    void eubx_replay_wait(struct eubx_replay *replay, uint32_t timeout_us);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* __linux__ */
+
+#endif /* EASYUBX_HOST_CAPTURE_H */
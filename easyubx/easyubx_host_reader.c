@@ -0,0 +1,235 @@
+/*
+ * source file for the Easy UBX C library for the threaded Linux transport
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#if defined(__linux__)
+
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "easyubx_host_reader.h"
+
+static void *reader_thread(void *usr_ptr);
+static bool wait_for_space(struct eubx_host_reader *reader);
+static void signal_fd(int fd);
+static void clear_fd(int fd);
+
+TEasyUBXError eubx_host_reader_start(struct eubx_host_reader *reader, int fd, uint8_t *buffer, uint32_t size)
+{
+    TEasyUBXError rc = eubx_spsc_init(&reader->ring, buffer, size);
+
+    if (EUBX_ERROR_OK == rc)
+    {
+        reader->fd = fd;
+        reader->data_fd = eventfd(0, EFD_NONBLOCK);
+        reader->space_fd = eventfd(0, EFD_NONBLOCK);
+        reader->stop_fd = eventfd(0, EFD_NONBLOCK);
+        reader->reader_waiting = 0;
+        reader->stalls = 0;
+        reader->bytes_read = 0;
+        reader->read_error = 0;
+        reader->running = (0 <= reader->data_fd) && (0 <= reader->space_fd) && (0 <= reader->stop_fd);
+
+        if (reader->running && (0 != pthread_create(&reader->thread, NULL, reader_thread, reader)))
+        {
+            reader->running = false;
+        }
+
+        if (!reader->running)
+        {
+            close(reader->data_fd);
+            close(reader->space_fd);
+            close(reader->stop_fd);
+            rc = EUBX_ERROR_NOT_INITIALIZED;
+        }
+    }
+
+    return rc;
+}
+
+void eubx_host_reader_stop(struct eubx_host_reader *reader)
+{
+    if (reader->running)
+    {
+        signal_fd(reader->stop_fd);
+        pthread_join(reader->thread, NULL);
+        reader->running = false;
+
+        close(reader->data_fd);
+        close(reader->space_fd);
+        close(reader->stop_fd);
+    }
+}
+
+size_t eubx_host_reader_drain(struct eubx_host_reader *reader, struct eubx_handle *pHandle)
+{
+    size_t drained = 0;
+    uint32_t count = 0;
+    const uint8_t *region = NULL;
+
+    // parses straight out of the ring, at most two regions when the data wraps
+    while (0 < (count = eubx_spsc_read_region(&reader->ring, &region)))
+    {
+        eubx_receive_bytes(pHandle, region, count);
+        eubx_spsc_consume(&reader->ring, count);
+        drained += count;
+
+        if (__atomic_load_n(&reader->reader_waiting, __ATOMIC_SEQ_CST))
+        {
+            signal_fd(reader->space_fd);
+        }
+    }
+
+    return drained;
+}
+
+uint16_t eubx_host_reader_read(struct eubx_host_reader *reader, uint8_t *buffer, uint16_t max_length)
+{
+    uint16_t count = eubx_spsc_read(&reader->ring, buffer, max_length);
+
+    if ((0 < count) && __atomic_load_n(&reader->reader_waiting, __ATOMIC_SEQ_CST))
+    {
+        signal_fd(reader->space_fd);
+    }
+
+    return count;
+}
+
+void eubx_host_reader_wait(struct eubx_host_reader *reader, uint32_t timeout_us)
+{
+    if (0 == eubx_spsc_used(&reader->ring))
+    {
+        struct pollfd pfd;
+
+        pfd.fd = reader->data_fd;
+        pfd.events = POLLIN;
+        poll(&pfd, 1, (timeout_us + 999) / 1000);
+    }
+
+    clear_fd(reader->data_fd);
+}
+
+int eubx_host_reader_error(const struct eubx_host_reader *reader)
+{
+    return __atomic_load_n(&reader->read_error, __ATOMIC_ACQUIRE);
+}
+
+void *reader_thread(void *usr_ptr)
+{
+    struct eubx_host_reader *reader = (struct eubx_host_reader *)usr_ptr;
+    struct pollfd pfd[2];
+    bool running = true;
+
+    pfd[0].fd = reader->fd;
+    pfd[0].events = POLLIN;
+    pfd[1].fd = reader->stop_fd;
+    pfd[1].events = POLLIN;
+
+    while (running)
+    {
+        uint8_t *region = NULL;
+        uint32_t count = eubx_spsc_write_region(&reader->ring, &region);
+
+        if (0 == count)
+        {
+            running = wait_for_space(reader);
+        }
+        else if (0 > poll(pfd, 2, -1))
+        {
+            running = (EINTR == errno);
+        }
+        else if (0 != pfd[1].revents)
+        {
+            running = false;
+        }
+        else if (0 != pfd[0].revents)
+        {
+            ssize_t length = read(reader->fd, region, count);
+
+            if (0 < length)
+            {
+                eubx_spsc_commit(&reader->ring, length);
+                reader->bytes_read += length;
+                signal_fd(reader->data_fd);
+            }
+            else if ((0 == length) || ((EAGAIN != errno) && (EINTR != errno)))
+            {
+                __atomic_store_n(&reader->read_error, (0 == length) ? EPIPE : errno, __ATOMIC_RELEASE);
+                running = false;
+                signal_fd(reader->data_fd);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+bool wait_for_space(struct eubx_host_reader *reader)
+{
+    uint8_t *region = NULL;
+    bool running = true;
+
+    reader->stalls++;
+    __atomic_store_n(&reader->reader_waiting, 1, __ATOMIC_SEQ_CST);
+
+    // checked again after announcing the wait, the consumer may have made room in between
+    if (0 == eubx_spsc_write_region(&reader->ring, &region))
+    {
+        struct pollfd pfd[2];
+
+        pfd[0].fd = reader->space_fd;
+        pfd[0].events = POLLIN;
+        pfd[1].fd = reader->stop_fd;
+        pfd[1].events = POLLIN;
+        poll(pfd, 2, -1);
+
+        running = (0 == pfd[1].revents);
+    }
+
+    __atomic_store_n(&reader->reader_waiting, 0, __ATOMIC_SEQ_CST);
+    clear_fd(reader->space_fd);
+
+    return running;
+}
+
+void signal_fd(int fd)
+{
+    uint64_t value = 1;
+
+    (void)write(fd, &value, sizeof(value));
+}
+
+void clear_fd(int fd)
+{
+    uint64_t value = 0;
+
+    (void)read(fd, &value, sizeof(value));
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,78 @@
+/*
+ * include file for the Easy UBX C library for the threaded Linux transport
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef EASYUBX_HOST_READER_H
+#define EASYUBX_HOST_READER_H
+
+#if defined(__linux__)
+
+#include <pthread.h>
+
+#include "easyubx_drv.h"
+#include "easyubx_drv_spsc.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /*
+     * A reader thread moves everything the file descriptor delivers into a byte ring with
+     * large reads, the parsing thread drains the ring through the bulk framer. Slow
+     * notification callbacks then only fill the ring instead of the kernel tty buffer.
+     */
+    struct eubx_host_reader
+    {
+        int fd;
+        int data_fd;  // eventfd, signalled after bytes were added to the ring
+        int space_fd; // eventfd, signalled after bytes were consumed while the reader waits
+        int stop_fd;  // eventfd, ends the reader thread
+        pthread_t thread;
+        bool running;
+        uint32_t reader_waiting;
+        uint32_t stalls;     // times the reader found the ring full
+        uint64_t bytes_read;
+        int read_error;      // errno of the failed read that ended the thread, 0 otherwise
+        struct eubx_spsc_ring ring;
+    };
+
+    TEasyUBXError eubx_host_reader_start(struct eubx_host_reader *reader, int fd, uint8_t *buffer, uint32_t size);
+    void eubx_host_reader_stop(struct eubx_host_reader *reader);
+
+    size_t eubx_host_reader_drain(struct eubx_host_reader *reader, struct eubx_handle *pHandle);
+    uint16_t eubx_host_reader_read(struct eubx_host_reader *reader, uint8_t *buffer, uint16_t max_length);
+    void eubx_host_reader_wait(struct eubx_host_reader *reader, uint32_t timeout_us);
+    int eubx_host_reader_error(const struct eubx_host_reader *reader); // errno that ended the reader thread, 0 while it runs
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* __linux__ */
+
+#endif /* EASYUBX_HOST_READER_H */
@@ -0,0 +1,539 @@
+/*
+ * Regression checks of the driver on synthetic streams, run with make check
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#if defined(__linux__)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "easyubx_drv.h"
+#include "easyubx_drv_consts.h"
+#include "easyubx_host_capture.h"
+
+#define REGRESS_STREAM_SIZE 4096
+#define REGRESS_MAX_EPOCHS 16
+#define REGRESS_RING_SIZE 256
+#define REGRESS_RING_RETAINED 3 // the third POSLLH payload lies at offset 56 of the ring
+#define REGRESS_MAX_SENT 8
+
+#define REGRESS_EXPECT(condition) expect((condition), #condition, __LINE__)
+
+struct regress_stream
+{
+    uint8_t data[REGRESS_STREAM_SIZE];
+    size_t length;
+};
+
+struct regress_check
+{
+    const char *name;
+    bool (*run)(void);
+};
+
+static struct eubx_nav_epoch epochs[REGRESS_MAX_EPOCHS];
+static unsigned epoch_count;
+static uint32_t clock_us;
+static struct eubx_handle *ring_handle;
+static struct eubx_message_view retained;
+static uint8_t retained_copy[EUBX_LENGTH_NAV_POSLLH];
+static unsigned ring_frames;
+static unsigned sent_frames;
+static uint8_t sent_ids[REGRESS_MAX_SENT];
+
+static bool expect(bool condition, const char *text, int line)
+{
+    if (!condition)
+    {
+        printf("  line %d: %s\n", line, text);
+    }
+
+    return condition;
+}
+
+static void append_ubx(struct regress_stream *stream, uint8_t message_class, uint8_t message_id, const uint8_t *payload, uint16_t length)
+{
+    uint8_t *frame = &stream->data[stream->length];
+    uint8_t ck_a = 0;
+    uint8_t ck_b = 0;
+
+    frame[0] = EUBX_SYNC1;
+    frame[1] = EUBX_SYNC2;
+    frame[2] = message_class;
+    frame[3] = message_id;
+    frame[4] = length & 0xff;
+    frame[5] = length >> 8;
+    memcpy(&frame[EUBX_FRAME_HEADER_LENGTH], payload, length);
+
+    eubx_checksum_update(&ck_a, &ck_b, &frame[2], length + EUBX_FRAME_HEADER_LENGTH - 2);
+    frame[EUBX_FRAME_HEADER_LENGTH + length] = ck_a;
+    frame[EUBX_FRAME_HEADER_LENGTH + length + 1] = ck_b;
+    stream->length += length + EUBX_FRAME_OVERHEAD;
+}
+
+// NAV message with nothing but the iTOW set, the first field of all of them
+static void append_nav(struct regress_stream *stream, uint8_t message_id, uint16_t length, uint32_t itow_ms)
+{
+    uint8_t payload[EUBX_LENGTH_NAV_PVT] = {0};
+
+    payload[0] = itow_ms & 0xff;
+    payload[1] = (itow_ms >> 8) & 0xff;
+    payload[2] = (itow_ms >> 16) & 0xff;
+    payload[3] = itow_ms >> 24;
+    append_ubx(stream, EUBX_CLASS_NAV, message_id, payload, length);
+}
+
+static void discard_byte(void *usr_ptr, uint8_t byte)
+{
+}
+
+static void discard_buffer(void *usr_ptr, const uint8_t *buffer, uint16_t length)
+{
+}
+
+static void count_buffer(void *usr_ptr, const uint8_t *buffer, uint16_t length)
+{
+    if (REGRESS_MAX_SENT > sent_frames)
+    {
+        sent_ids[sent_frames] = buffer[3];
+    }
+
+    sent_frames++;
+}
+
+static uint16_t no_input(void *usr_ptr, uint8_t *buffer, uint16_t max_length)
+{
+    return 0;
+}
+
+// every reading moves the clock on by a millisecond, so waits run into their timeout at once
+static uint32_t advance_clock(void *usr_ptr)
+{
+    clock_us += 1000;
+
+    return clock_us;
+}
+
+// only moves when a check sets it
+static uint32_t fixed_clock(void *usr_ptr)
+{
+    return clock_us;
+}
+
+static void record_epoch(void *usr_ptr, const struct eubx_nav_epoch *epoch)
+{
+    if (REGRESS_MAX_EPOCHS > epoch_count)
+    {
+        epochs[epoch_count] = *epoch;
+    }
+
+    epoch_count++;
+}
+
+static void retain_frame(void *usr_ptr, const struct eubx_message_view *view)
+{
+    if (REGRESS_RING_RETAINED == ++ring_frames)
+    {
+        retained = *view;
+        memcpy(retained_copy, view->payload, view->message_length);
+        eubx_retain_message(ring_handle, view);
+    }
+}
+
+// the bring-up polls go nowhere and are never answered, nothing waits for them either
+static void init_handle(struct eubx_handle *pHandle, eubx_get_time get_time)
+{
+    struct eubx_init_options options;
+
+    memset(&options, 0, sizeof(options));
+    options.nonblocking = true;
+    options.get_time = get_time;
+    options.notify_epoch = record_epoch;
+    epoch_count = 0;
+
+    eubx_init_ex(pHandle, no_input, discard_byte, discard_buffer, NULL, NULL, &options);
+}
+
+// runs the stream through a capture file, the way a recorded session is replayed
+static bool replay_stream(struct eubx_handle *pHandle, const struct regress_stream *stream)
+{
+    char path[] = "/tmp/easyubx_regress_XXXXXX";
+    struct eubx_capture_writer writer;
+    struct eubx_replay replay;
+    bool replayed = false;
+    int fd = mkstemp(path);
+
+    if ((0 <= fd) && (EUBX_ERROR_OK == eubx_capture_open(&writer, path)))
+    {
+        eubx_capture_tap(&writer, EUBXDirectionRx, stream->data, stream->length);
+        eubx_capture_close(&writer);
+
+        if (EUBX_ERROR_OK == eubx_replay_open(&replay, path, false))
+        {
+            replayed = (stream->length == eubx_replay_run(&replay, pHandle));
+            eubx_replay_close(&replay);
+        }
+    }
+
+    if (0 <= fd)
+    {
+        close(fd);
+        unlink(path);
+    }
+
+    return replayed;
+}
+
+// NAV-POSLLH and the NAV-EOE closing the epoch
+static void append_epoch(struct regress_stream *stream, uint32_t itow_ms)
+{
+    append_nav(stream, EUBX_ID_NAV_POSLLH, EUBX_LENGTH_NAV_POSLLH, itow_ms);
+    append_nav(stream, EUBX_ID_NAV_EOE, EUBX_LENGTH_NAV_EOE, itow_ms);
+}
+
+/*
+ * Epochs across the end of the GPS week and a receiver reset. Every NAV frame is decoded,
+ * only the one of an epoch already closed is counted as late and kept out of the epochs.
+ */
+static bool check_epoch_week_rollover(void)
+{
+    static const uint32_t itows[] = {604799000, 0, 1000, 2000, 300000000, 5000};
+    static struct regress_stream stream;
+    struct eubx_handle handle;
+    struct eubx_nav_epoch snapshot;
+    struct eubx_stats stats;
+    bool passed = true;
+
+    stream.length = 0;
+
+    for (unsigned i = 0; i < sizeof(itows) / sizeof(itows[0]); i++)
+    {
+        // a frame of the epoch before arrives between the frames of this one
+        if (2000 == itows[i])
+        {
+            append_nav(&stream, EUBX_ID_NAV_POSLLH, EUBX_LENGTH_NAV_POSLLH, itows[i]);
+            append_nav(&stream, EUBX_ID_NAV_PVT, EUBX_LENGTH_NAV_PVT, 1000);
+        }
+
+        append_epoch(&stream, itows[i]);
+    }
+
+    init_handle(&handle, NULL);
+    passed &= REGRESS_EXPECT(replay_stream(&handle, &stream));
+    eubx_get_stats(&handle, &stats);
+
+    passed &= REGRESS_EXPECT(sizeof(itows) / sizeof(itows[0]) == epoch_count);
+    passed &= REGRESS_EXPECT(1 == stats.nav_late_frames);
+
+    for (unsigned i = 0; (i < epoch_count) && (i < sizeof(itows) / sizeof(itows[0])); i++)
+    {
+        passed &= REGRESS_EXPECT(itows[i] == epochs[i].itow_ms);
+        passed &= REGRESS_EXPECT(itows[i] == epochs[i].posllh.itow_ms);
+        passed &= REGRESS_EXPECT(EUBXEpochEnd == epochs[i].closed_by);
+        passed &= REGRESS_EXPECT(0 == (EUBX_NAV_MESSAGE_PVT & epochs[i].messages));
+        passed &= REGRESS_EXPECT(0 == epochs[i].pvt.itow_ms);
+    }
+
+    passed &= REGRESS_EXPECT(5000 == handle.nav_posllh.itow_ms);
+    passed &= REGRESS_EXPECT(1000 == handle.nav_pvt.itow_ms);
+    passed &= REGRESS_EXPECT(sizeof(itows) / sizeof(itows[0]) == eubx_read_nav_snapshot(&handle, &snapshot));
+    passed &= REGRESS_EXPECT(5000 == snapshot.itow_ms);
+
+    return passed;
+}
+
+/*
+ * A wait timing out while a frame is half received must neither drop that frame nor have
+ * its error returned for the next chunk, a bad checksum is only reported for its own.
+ */
+static bool check_frame_across_wait(void)
+{
+    static struct regress_stream stream;
+    struct eubx_handle handle;
+    bool passed = true;
+
+    stream.length = 0;
+    append_nav(&stream, EUBX_ID_NAV_POSLLH, EUBX_LENGTH_NAV_POSLLH, 1000);
+
+    init_handle(&handle, advance_clock);
+    passed &= REGRESS_EXPECT(EUBX_ERROR_OK == eubx_receive_bytes(&handle, stream.data, 10));
+    passed &= REGRESS_EXPECT(EUBX_ERROR_TIMEOUT == eubx_waitfor_event_timeout(&handle, EUBXReceivedNavPVT, 5));
+    passed &= REGRESS_EXPECT(EUBX_ERROR_OK == eubx_receive_bytes(&handle, &stream.data[10], stream.length - 10));
+    passed &= REGRESS_EXPECT(1000 == handle.nav_posllh.itow_ms);
+
+    stream.data[stream.length - 1] ^= 0xff;
+    passed &= REGRESS_EXPECT(EUBX_ERROR_CHECKSUM == eubx_receive_bytes(&handle, stream.data, stream.length));
+    stream.data[stream.length - 1] ^= 0xff;
+    passed &= REGRESS_EXPECT(EUBX_ERROR_OK == eubx_receive_bytes(&handle, stream.data, stream.length));
+
+    return passed;
+}
+
+/*
+ * Payloads of a ring arena wrap around a retained one. When the head has wrapped up to
+ * the retained payload the ring is full, later frames are dropped instead of overwriting it.
+ */
+static bool check_ring_retained(void)
+{
+    static uint8_t ring[REGRESS_RING_SIZE];
+    static struct regress_stream stream;
+    struct eubx_handle handle;
+    struct eubx_init_options options;
+    struct eubx_stats stats;
+    bool passed = true;
+
+    memset(&options, 0, sizeof(options));
+    options.nonblocking = true;
+    options.receive_arena = ring;
+    options.receive_arena_size = sizeof(ring);
+    options.receive_arena_mode = EUBXArenaRing;
+    options.notify_message = retain_frame;
+    eubx_init_ex(&handle, no_input, discard_byte, discard_buffer, NULL, NULL, &options);
+    ring_handle = &handle;
+    ring_frames = 0;
+
+    // 6 more payloads fill the ring up to its end, 2 fit in front of the retained one
+    for (uint32_t i = 0; i < 20; i++)
+    {
+        stream.length = 0;
+        append_nav(&stream, EUBX_ID_NAV_POSLLH, EUBX_LENGTH_NAV_POSLLH, 1000 * i);
+        eubx_receive_bytes(&handle, stream.data, stream.length);
+        passed &= REGRESS_EXPECT((REGRESS_RING_RETAINED > i) || (0 == memcmp(retained.payload, retained_copy, sizeof(retained_copy))));
+    }
+
+    eubx_get_stats(&handle, &stats);
+    passed &= REGRESS_EXPECT(56 == retained.payload - ring);
+    passed &= REGRESS_EXPECT(REGRESS_RING_RETAINED + 8 == ring_frames);
+    passed &= REGRESS_EXPECT(20 - ring_frames == stats.overflows);
+
+    // released, the ring takes frames again
+    eubx_release_message(&handle, &retained);
+    stream.length = 0;
+    append_nav(&stream, EUBX_ID_NAV_POSLLH, EUBX_LENGTH_NAV_POSLLH, 20000);
+    passed &= REGRESS_EXPECT(EUBX_ERROR_OK == eubx_receive_bytes(&handle, stream.data, stream.length));
+    passed &= REGRESS_EXPECT(20000 == handle.nav_posllh.itow_ms);
+
+    return passed;
+}
+
+/*
+ * An event loop reading the transport itself sleeps until eubx_time_to_deadline, the poll
+ * schedule, the request timeout and the epoch timeout have to be due by then.
+ */
+static bool check_timer_deadline(void)
+{
+    static struct regress_stream stream;
+    struct eubx_handle handle;
+    struct eubx_init_options options;
+    bool passed = true;
+
+    memset(&options, 0, sizeof(options));
+    options.nonblocking = true;
+    options.get_time = fixed_clock;
+    options.notify_epoch = record_epoch;
+    clock_us = 0;
+    epoch_count = 0;
+    eubx_init_ex(&handle, no_input, discard_byte, count_buffer, NULL, NULL, &options);
+
+    // the bring-up polls time out unanswered
+    clock_us += 10000000;
+    eubx_run_timers(&handle);
+    passed &= REGRESS_EXPECT(EUBX_NO_DEADLINE == eubx_time_to_deadline(&handle));
+
+    sent_frames = 0;
+    passed &= REGRESS_EXPECT(EUBX_ERROR_OK == eubx_schedule_poll(&handle, EUBX_CLASS_NAV, EUBX_ID_NAV_PVT, 2000));
+    passed &= REGRESS_EXPECT(0 == eubx_time_to_deadline(&handle));
+    eubx_run_timers(&handle);
+    passed &= REGRESS_EXPECT(1 == sent_frames);
+    passed &= REGRESS_EXPECT(EUBX_TIMEOUT_DEFAULT_MS == eubx_time_to_deadline(&handle));
+
+    // the poll times out, the next one is due a second later
+    clock_us += EUBX_TIMEOUT_DEFAULT_MS * 1000;
+    passed &= REGRESS_EXPECT(0 == eubx_time_to_deadline(&handle));
+    eubx_run_timers(&handle);
+    passed &= REGRESS_EXPECT(0 == eubx_pending_requests(&handle));
+    passed &= REGRESS_EXPECT(2000 - EUBX_TIMEOUT_DEFAULT_MS == eubx_time_to_deadline(&handle));
+    clock_us += (2000 - EUBX_TIMEOUT_DEFAULT_MS) * 1000;
+    eubx_run_timers(&handle);
+    passed &= REGRESS_EXPECT(2 == sent_frames);
+
+    // a receiver without NAV-EOE, the epoch closes after the quiet time
+    eubx_schedule_poll(&handle, EUBX_CLASS_NAV, EUBX_ID_NAV_PVT, 0);
+    stream.length = 0;
+    append_nav(&stream, EUBX_ID_NAV_POSLLH, EUBX_LENGTH_NAV_POSLLH, 1000);
+    eubx_receive_bytes(&handle, stream.data, stream.length);
+    passed &= REGRESS_EXPECT(EUBX_NAV_EPOCH_TIMEOUT_MS == eubx_time_to_deadline(&handle));
+    clock_us += EUBX_NAV_EPOCH_TIMEOUT_MS * 1000;
+    eubx_run_timers(&handle);
+    passed &= REGRESS_EXPECT(1 == epoch_count);
+    passed &= REGRESS_EXPECT(EUBX_TIMEOUT_DEFAULT_MS - EUBX_NAV_EPOCH_TIMEOUT_MS == eubx_time_to_deadline(&handle));
+
+    return passed;
+}
+
+/*
+ * A silent receiver without get_time: the blocking bring-up gives up after the spin limit.
+ * With a clock a timeout longer than the microsecond clock can measure is cut to the limit.
+ */
+static bool check_wait_deadline(void)
+{
+    struct eubx_handle handle;
+    uint32_t start;
+    bool passed = true;
+
+    passed &= REGRESS_EXPECT(EUBX_ERROR_TIMEOUT == eubx_init(&handle, no_input, discard_byte, discard_buffer, NULL, NULL));
+    passed &= REGRESS_EXPECT(EUBX_ERROR_OK == eubx_request_poll(&handle, EUBX_CLASS_NAV, EUBX_ID_NAV_PVT, NULL, NULL));
+    passed &= REGRESS_EXPECT(EUBX_ERROR_TIMEOUT == eubx_waitfor_requests(&handle));
+
+    init_handle(&handle, advance_clock);
+    start = clock_us;
+    passed &= REGRESS_EXPECT(EUBX_ERROR_TIMEOUT == eubx_waitfor_event_timeout(&handle, EUBXReceivedNavPVT, 5000000));
+    passed &= REGRESS_EXPECT((uint32_t)EUBX_WAIT_LIMIT_MS * 1000 <= clock_us - start);
+
+    return passed;
+}
+
+/*
+ * CFG-GNSS of a receiver with more constellations than the block table holds: only the
+ * first EUBX_GNSS_BLOCK_COUNT are kept and the handle behind the table stays untouched.
+ */
+static bool check_cfg_gnss_blocks(void)
+{
+    static struct regress_stream stream;
+    uint8_t payload[EUBX_LENGTH_CFG_GNSS_HEADER + 12 * EUBX_LENGTH_CFG_GNSS_BLOCK];
+    struct eubx_handle handle;
+    TEasyUBXWarmStatus warm_status;
+    bool passed = true;
+
+    memset(payload, 0xaa, sizeof(payload));
+    payload[3] = 12;
+
+    for (uint8_t i = 0; i < 12; i++)
+    {
+        payload[EUBX_LENGTH_CFG_GNSS_HEADER + i * EUBX_LENGTH_CFG_GNSS_BLOCK] = i;
+    }
+
+    init_handle(&handle, NULL);
+    warm_status = handle.warm_status;
+    stream.length = 0;
+    append_ubx(&stream, EUBX_CLASS_CFG, EUBX_ID_CFG_GNSS, payload, sizeof(payload));
+    passed &= REGRESS_EXPECT(EUBX_ERROR_OK == eubx_receive_bytes(&handle, stream.data, stream.length));
+    passed &= REGRESS_EXPECT(EUBX_GNSS_BLOCK_COUNT == handle.receiver_config.gnss.block_count);
+    passed &= REGRESS_EXPECT(EUBX_GNSS_BLOCK_COUNT - 1 == handle.receiver_config.gnss.blocks[EUBX_GNSS_BLOCK_COUNT - 1].gnss_id);
+    passed &= REGRESS_EXPECT(warm_status == handle.warm_status);
+
+    // a reply without the header is refused instead of decoded from stale bytes
+    stream.length = 0;
+    append_ubx(&stream, EUBX_CLASS_CFG, EUBX_ID_CFG_GNSS, payload, 2);
+    passed &= REGRESS_EXPECT(EUBX_ERROR_LENGTH == eubx_receive_bytes(&handle, stream.data, stream.length));
+    passed &= REGRESS_EXPECT(EUBX_GNSS_BLOCK_COUNT == handle.receiver_config.gnss.block_count);
+
+    return passed;
+}
+
+/*
+ * A blocking send must not overtake frames the request engine queued before, and the
+ * round trip of a queued request starts when the queue is written, not when it was queued.
+ */
+static bool check_queued_send(void)
+{
+    static uint8_t tx_queue[256];
+    struct eubx_handle handle;
+    struct eubx_init_options options;
+    bool passed = true;
+
+    memset(&options, 0, sizeof(options));
+    options.nonblocking = true;
+    options.get_time = fixed_clock;
+    options.tx_queue = tx_queue;
+    options.tx_queue_size = sizeof(tx_queue);
+    clock_us = 0;
+    eubx_init_ex(&handle, no_input, discard_byte, count_buffer, NULL, NULL, &options);
+    clock_us += 10000000;
+    eubx_run_timers(&handle);
+
+    sent_frames = 0;
+    passed &= REGRESS_EXPECT(EUBX_ERROR_OK == eubx_request_poll(&handle, EUBX_CLASS_NAV, EUBX_ID_NAV_PVT, NULL, NULL));
+    passed &= REGRESS_EXPECT(0 == sent_frames);
+
+    clock_us += 300000;
+    handle.send_message.message_class = EUBX_CLASS_NAV;
+    handle.send_message.message_id = EUBX_ID_NAV_POSLLH;
+    handle.send_message.message_length = 0;
+    passed &= REGRESS_EXPECT(EUBX_ERROR_OK == eubx_send_message(&handle));
+    passed &= REGRESS_EXPECT(2 == sent_frames);
+    passed &= REGRESS_EXPECT((EUBX_ID_NAV_PVT == sent_ids[0]) && (EUBX_ID_NAV_POSLLH == sent_ids[1]));
+
+    for (int i = 0; i < EUBX_MAX_PENDING_REQUESTS; i++)
+    {
+        const struct eubx_request *request = &handle.requests[i];
+
+        passed &= REGRESS_EXPECT(!request->in_use || (EUBX_ID_NAV_PVT != request->message_id) || (clock_us == request->send_time));
+    }
+
+    return passed;
+}
+
+static const struct regress_check checks[] = {
+    {"epoch_week_rollover", check_epoch_week_rollover},
+    {"frame_across_wait", check_frame_across_wait},
+    {"ring_retained", check_ring_retained},
+    {"timer_deadline", check_timer_deadline},
+    {"wait_deadline", check_wait_deadline},
+    {"cfg_gnss_blocks", check_cfg_gnss_blocks},
+    {"queued_send", check_queued_send},
+};
+
+// runs all checks or the ones named on the command line
+int main(int argc, char **argv)
+{
+    int failed = 0;
+
+    for (unsigned i = 0; i < sizeof(checks) / sizeof(checks[0]); i++)
+    {
+        bool selected = (1 == argc);
+
+        for (int arg = 1; arg < argc; arg++)
+        {
+            selected |= (0 == strcmp(argv[arg], checks[i].name));
+        }
+
+        if (selected)
+        {
+            bool passed = checks[i].run();
+
+            printf("%s: %s\n", checks[i].name, passed ? "ok" : "FAILED");
+            failed += passed ? 0 : 1;
+        }
+    }
+
+    return (0 == failed) ? 0 : 1;
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,740 @@
+/*
+ * Linux daemon serving many receivers with the Easy UBX C library
+ */
+
+/*
+   MIT License
+
+  Copyright (c) 2019 Bernd Wiegmann (bernd@iotinsights.de)
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#if defined(__linux__)
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "easyubx_drv.h"
+#include "easyubx_drv_consts.h"
+#include "easyubx_host_cache.h"
+
+#define EUBXD_MAX_DEVICES 256
+#define EUBXD_MAX_WORKERS 64
+#define EUBXD_READ_SIZE 4096
+#define EUBXD_TX_QUEUE_SIZE 512
+#define EUBXD_PATH_LENGTH 256
+#define EUBXD_REOPEN_MS 1000       // retry interval for a device that hung up
+#define EUBXD_WRITE_TIMEOUT_MS 500 // longest wait for room in the output buffer of a device
+
+/*
+ * Every device has its own handle and belongs to exactly one worker, so handles are
+ * never shared between threads. Workers sleep in epoll_wait until one of their
+ * descriptors is readable and drain it without blocking. A device that hangs up, e.g. an
+ * unplugged USB receiver, is closed and opened again every EUBXD_REOPEN_MS.
+ */
+struct eubxd_device
+{
+    const char *path;
+    int fd;
+    speed_t speed;
+    uint32_t reopen_time; // host time of the next attempt while fd is closed
+    bool ready;
+    char name[2 * EUBX_UNIQUE_ID_LENGTH + 1]; // SEC-UNIQID in hex, the path until it is known
+    uint64_t events;
+    char state_path[EUBXD_PATH_LENGTH]; // empty without -s
+    bool save_state;                    // set once the receiver confirmed or replaced the cached state
+    struct eubx_handle handle;
+    uint8_t tx_queue[EUBXD_TX_QUEUE_SIZE];
+};
+
+struct eubxd_worker
+{
+    int index;
+    int cpu; // -1 leaves the thread unpinned
+    int epoll_fd;
+    pthread_t thread;
+    struct eubxd_device *devices[EUBXD_MAX_DEVICES];
+    int device_count;
+};
+
+static struct eubxd_device devices[EUBXD_MAX_DEVICES];
+static struct eubxd_worker workers[EUBXD_MAX_WORKERS];
+static int stop_fd = -1;
+static int stats_fd = -1;
+static uint32_t telemetry_interval_ms = 0;
+static const char *state_dir = NULL;
+static volatile sig_atomic_t stopping = 0;
+
+static uint16_t device_receive_buffer(void *usr_ptr, uint8_t *buffer, uint16_t max_length);
+static void device_send_byte(void *usr_ptr, uint8_t byte);
+static void device_send_buffer(void *usr_ptr, const uint8_t *buffer, uint16_t length);
+static void device_send_vector(void *usr_ptr, const struct eubx_tx_segment *segments, uint8_t count);
+static void device_wait_input(void *usr_ptr, uint32_t timeout_us);
+static void device_notify_event(void *usr_ptr, TEasyUBXEvent event);
+static uint32_t host_time_us(void *usr_ptr);
+
+static bool open_device(struct eubxd_device *device, speed_t speed);
+static void start_device(struct eubxd_device *device);
+static void name_device(struct eubxd_device *device);
+static void device_ready(struct eubxd_device *device);
+static bool drain_device(struct eubxd_device *device);
+static void close_device(struct eubxd_worker *worker, struct eubxd_device *device);
+static void reopen_devices(struct eubxd_worker *worker);
+static bool write_device(struct eubxd_device *device, struct iovec *iov, int count);
+static void print_stats(struct eubxd_device *device);
+static void *worker_thread(void *usr_ptr);
+static void handle_signal(int signal_number);
+static speed_t baud_to_speed(long baud);
+static void usage(const char *program);
+
+int main(int argc, char **argv)
+{
+    int worker_count = 1;
+    int first_cpu = -1;
+    speed_t speed = B9600;
+    int device_count = 0;
+    int option;
+    struct sigaction action;
+
+    while (-1 != (option = getopt(argc, argv, "w:c:b:m:s:h")))
+    {
+        switch (option)
+        {
+        case 'w':
+            worker_count = atoi(optarg);
+            break;
+
+        case 'c':
+            first_cpu = atoi(optarg);
+            break;
+
+        case 'b':
+            speed = baud_to_speed(atol(optarg));
+            break;
+
+        case 'm':
+            telemetry_interval_ms = strtoul(optarg, NULL, 0);
+            break;
+
+        case 's':
+            state_dir = optarg;
+            break;
+
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    device_count = argc - optind;
+
+    if ((0 == device_count) || (EUBXD_MAX_DEVICES < device_count) || (0 == speed) || (1 > worker_count) || (EUBXD_MAX_WORKERS < worker_count))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (worker_count > device_count)
+    {
+        worker_count = device_count;
+    }
+
+    stop_fd = eventfd(0, EFD_NONBLOCK);
+    stats_fd = eventfd(0, 0);
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_signal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    sigaction(SIGUSR1, &action, NULL);
+
+    for (int i = 0; i < worker_count; i++)
+    {
+        workers[i].index = i;
+        workers[i].cpu = (0 <= first_cpu) ? (first_cpu + i) % sysconf(_SC_NPROCESSORS_ONLN) : -1;
+        workers[i].epoll_fd = epoll_create1(0);
+        workers[i].device_count = 0;
+    }
+
+    // devices are spread round robin, each one is owned by a single worker
+    for (int i = 0; i < device_count; i++)
+    {
+        struct eubxd_worker *worker = &workers[i % worker_count];
+
+        devices[i].path = argv[optind + i];
+        worker->devices[worker->device_count++] = &devices[i];
+
+        // a receiver that is not plugged in yet is retried by its worker like one that hung up
+        if (!open_device(&devices[i], speed))
+        {
+            fprintf(stderr, "%s: %s, retrying every %u ms\n", devices[i].path, strerror(errno), EUBXD_REOPEN_MS);
+            devices[i].reopen_time = host_time_us(NULL) + EUBXD_REOPEN_MS * 1000;
+        }
+    }
+
+    for (int i = 0; i < worker_count; i++)
+    {
+        pthread_create(&workers[i].thread, NULL, worker_thread, &workers[i]);
+    }
+
+    // SIGUSR1 prints the counters of every device while the workers keep running
+    while (!stopping)
+    {
+        uint64_t value;
+
+        if ((sizeof(value) == read(stats_fd, &value, sizeof(value))) && !stopping)
+        {
+            for (int i = 0; i < device_count; i++)
+            {
+                print_stats(&devices[i]);
+            }
+        }
+    }
+
+    for (int i = 0; i < worker_count; i++)
+    {
+        pthread_join(workers[i].thread, NULL);
+    }
+
+    for (int i = 0; i < device_count; i++)
+    {
+        if (0 <= devices[i].fd)
+        {
+            printf("%s: %lu events\n", devices[i].name, (unsigned long)devices[i].events);
+            print_stats(&devices[i]);
+            close(devices[i].fd);
+        }
+    }
+
+    return 0;
+}
+
+void *worker_thread(void *usr_ptr)
+{
+    struct eubxd_worker *worker = (struct eubxd_worker *)usr_ptr;
+    struct epoll_event events[EUBXD_MAX_DEVICES];
+    struct epoll_event event;
+    bool running = true;
+
+    if (0 <= worker->cpu)
+    {
+        cpu_set_t cpus;
+
+        CPU_ZERO(&cpus);
+        CPU_SET(worker->cpu, &cpus);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    }
+
+    // init only sends the first polls, all devices of a worker come up together in the loop below
+    for (int i = 0; i < worker->device_count; i++)
+    {
+        if (0 <= worker->devices[i]->fd)
+        {
+            start_device(worker->devices[i]);
+
+            event.events = EPOLLIN;
+            event.data.ptr = worker->devices[i];
+            epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, worker->devices[i]->fd, &event);
+        }
+    }
+
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;
+    epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, stop_fd, &event);
+
+    while (running)
+    {
+        uint32_t deadline_ms = EUBX_NO_DEADLINE;
+        int timeout_ms = -1;
+        int count = 0;
+
+        // sleeps until data arrives or the earliest poll, timeout or reopen of a device is due
+        for (int i = 0; i < worker->device_count; i++)
+        {
+            uint32_t device_ms = (0 > worker->devices[i]->fd) ? EUBXD_REOPEN_MS : eubx_time_to_deadline(&worker->devices[i]->handle);
+
+            if (device_ms < deadline_ms)
+            {
+                deadline_ms = device_ms;
+            }
+        }
+
+        if (EUBX_NO_DEADLINE != deadline_ms)
+        {
+            timeout_ms = (EUBXD_REOPEN_MS < deadline_ms) ? EUBXD_REOPEN_MS : (int)deadline_ms;
+        }
+
+        count = epoll_wait(worker->epoll_fd, events, EUBXD_MAX_DEVICES, timeout_ms);
+
+        for (int i = 0; i < count; i++)
+        {
+            struct eubxd_device *device = (struct eubxd_device *)events[i].data.ptr;
+
+            if (NULL == device)
+            {
+                running = false;
+            }
+            else if (!drain_device(device) || (0 != (events[i].events & (EPOLLHUP | EPOLLERR))))
+            {
+                // a level triggered descriptor that hung up would wake the worker again at once
+                close_device(worker, device);
+            }
+        }
+
+        // the input was drained above, only the timed work is left
+        for (int i = 0; i < worker->device_count; i++)
+        {
+            if (0 <= worker->devices[i]->fd)
+            {
+                eubx_run_timers(&worker->devices[i]->handle);
+            }
+        }
+
+        reopen_devices(worker);
+    }
+
+    return NULL;
+}
+
+bool open_device(struct eubxd_device *device, speed_t speed)
+{
+    struct termios tty;
+
+    snprintf(device->name, sizeof(device->name), "%s", device->path);
+    device->ready = false;
+    device->events = 0;
+    device->speed = speed;
+    device->fd = open(device->path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+
+    if ((0 <= device->fd) && (0 == tcgetattr(device->fd, &tty)))
+    {
+        cfmakeraw(&tty);
+        cfsetospeed(&tty, speed);
+        cfsetispeed(&tty, speed);
+        tty.c_cflag |= (CLOCAL | CREAD);
+        tty.c_cflag &= ~(CSTOPB | CRTSCTS);
+        // with O_NONBLOCK an empty input fails with EAGAIN, so reading 0 bytes means a hang up
+        tty.c_cc[VMIN] = 1;
+        tty.c_cc[VTIME] = 0;
+        tcsetattr(device->fd, TCSANOW, &tty);
+    }
+
+    return 0 <= device->fd;
+}
+
+void start_device(struct eubxd_device *device)
+{
+    struct eubx_init_options options;
+    uint8_t state[EUBX_WARM_STATE_SIZE];
+    uint16_t state_length = 0;
+    const char *base = strrchr(device->path, '/');
+
+    memset(&options, 0, sizeof(options));
+    options.tx_queue = device->tx_queue;
+    options.tx_queue_size = sizeof(device->tx_queue);
+    options.send_vector = device_send_vector;
+    options.get_time = host_time_us;
+    options.wait_input = device_wait_input;
+    options.fast_resync = true;
+    options.nonblocking = true;
+
+    // one file per port, a receiver moved to another port fails verification and is polled again
+    if ((NULL != state_dir) &&
+        (sizeof(device->state_path) > (size_t)snprintf(device->state_path, sizeof(device->state_path), "%s/%s.state", state_dir, (NULL != base) ? base + 1 : device->path)) &&
+        (EUBX_ERROR_OK == eubx_cache_load(device->state_path, state, sizeof(state), &state_length)))
+    {
+        options.warm_state = state;
+        options.warm_state_length = state_length;
+    }
+
+    // the bring-up continues in the worker loop, EUBXBringUpReady calls device_ready
+    if (EUBX_ERROR_OK != eubx_init_ex(&device->handle, device_receive_buffer, device_send_byte, device_send_buffer, device_notify_event, device, &options))
+    {
+        fprintf(stderr, "%s: cannot start the receiver\n", device->path);
+    }
+}
+
+void device_ready(struct eubxd_device *device)
+{
+    if (EUBXWarmVerifying == device->handle.warm_status)
+    {
+        // the cached chip id names the device, a failed verification renames it later
+        name_device(device);
+    }
+    else
+    {
+        // u-blox 7 and older have no chip id and keep the path as name
+        eubx_request_poll(&device->handle, EUBX_CLASS_SEC, EUBX_ID_SEC_UNIQID, NULL, NULL);
+    }
+
+    if (0 < telemetry_interval_ms)
+    {
+        eubx_schedule_mon_telemetry(&device->handle, telemetry_interval_ms);
+    }
+
+    device->ready = true;
+    printf("%s: %s, software %s%s\n", device->path, device->name, device->handle.receiver_info.software_version,
+           (EUBXWarmVerifying == device->handle.warm_status) ? " (cached)" : "");
+}
+
+void name_device(struct eubxd_device *device)
+{
+    for (int i = 0; i < device->handle.receiver_info.unique_id_length; i++)
+    {
+        snprintf(&device->name[2 * i], 3, "%02x", device->handle.receiver_info.unique_id[i]);
+    }
+}
+
+// false once the device hung up
+bool drain_device(struct eubxd_device *device)
+{
+    uint8_t buffer[EUBXD_READ_SIZE];
+    ssize_t length;
+    bool connected = true;
+
+    // edge or level, reading until EAGAIN leaves nothing behind for the next wakeup
+    while (0 < (length = read(device->fd, buffer, sizeof(buffer))))
+    {
+        eubx_receive_bytes(&device->handle, buffer, length);
+    }
+
+    // a tty reads 0 bytes after a hang up, a pty fails with EIO once its master is closed
+    if ((0 == length) || ((EAGAIN != errno) && (EINTR != errno)))
+    {
+        connected = false;
+    }
+    else
+    {
+        eubx_flush_queue(&device->handle);
+    }
+
+    // after a mismatch the state is complete again once the background polls are answered
+    if (connected && device->save_state && ('\0' != device->state_path[0]) && (0 == eubx_pending_requests(&device->handle)))
+    {
+        device->save_state = false;
+        name_device(device);
+
+        if (EUBX_ERROR_OK != eubx_cache_store(device->state_path, &device->handle))
+        {
+            fprintf(stderr, "%s: cannot write %s\n", device->name, device->state_path);
+        }
+    }
+
+    return connected;
+}
+
+void close_device(struct eubxd_worker *worker, struct eubxd_device *device)
+{
+    fprintf(stderr, "%s: %s hung up, reopening every %u ms\n", device->name, device->path, EUBXD_REOPEN_MS);
+
+    epoll_ctl(worker->epoll_fd, EPOLL_CTL_DEL, device->fd, NULL);
+    close(device->fd);
+    device->fd = -1;
+    device->ready = false;
+    device->reopen_time = host_time_us(NULL) + EUBXD_REOPEN_MS * 1000;
+}
+
+// a reopened device is brought up again like at start, with the cached state if there is one
+void reopen_devices(struct eubxd_worker *worker)
+{
+    uint32_t now = host_time_us(NULL);
+    struct epoll_event event;
+
+    for (int i = 0; i < worker->device_count; i++)
+    {
+        struct eubxd_device *device = worker->devices[i];
+
+        if ((0 > device->fd) && (0 <= (int32_t)(now - device->reopen_time)))
+        {
+            if (open_device(device, device->speed))
+            {
+                fprintf(stderr, "%s: reopened\n", device->path);
+                start_device(device);
+
+                event.events = EPOLLIN;
+                event.data.ptr = device;
+                epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, device->fd, &event);
+            }
+            else
+            {
+                device->reopen_time = now + EUBXD_REOPEN_MS * 1000;
+            }
+        }
+    }
+}
+
+void print_stats(struct eubxd_device *device)
+{
+    struct eubx_stats stats;
+    struct eubx_nav_epoch snapshot;
+
+    if (0 <= device->fd)
+    {
+        eubx_get_stats(&device->handle, &stats);
+        printf("%s: %u bytes, %u frames, %u nmea, %u rtcm, errors checksum=%u length=%u overflow=%u unknown=%u nak=%u timeout=%u, %u resyncs\n",
+               device->name, stats.bytes_in, stats.frames, stats.nmea_sentences, stats.rtcm_frames, stats.checksum_errors, stats.length_errors,
+               stats.overflows, stats.unknown_classes, stats.naks, stats.timeouts, stats.resyncs);
+        printf("%s: latency p50<%uus p99<%uus, rtt p50<%uus p99<%uus\n", device->name,
+               eubx_stats_percentile(stats.callback_latency, 50), eubx_stats_percentile(stats.callback_latency, 99),
+               eubx_stats_percentile(stats.rtt, 50), eubx_stats_percentile(stats.rtt, 99));
+        printf("%s: %u epochs, %u incomplete, %u late frames\n", device->name, stats.nav_epochs, stats.nav_incomplete_epochs, stats.nav_late_frames);
+
+        // runs in the main thread while the worker parses, the snapshot is the only consistent view
+        if ((0 < eubx_read_nav_snapshot(&device->handle, &snapshot)) && (0 != (EUBX_NAV_MESSAGE_PVT & snapshot.messages)))
+        {
+            printf("%s: epoch %u itow=%ums fix=%u sv=%u lat=%d lon=%d\n", device->name, snapshot.number, snapshot.itow_ms, snapshot.pvt.fix_type,
+                   snapshot.pvt.num_sv, snapshot.pvt.latitude_deg_e7, snapshot.pvt.longitude_deg_e7);
+        }
+    }
+}
+
+uint16_t device_receive_buffer(void *usr_ptr, uint8_t *buffer, uint16_t max_length)
+{
+    struct eubxd_device *device = (struct eubxd_device *)usr_ptr;
+    ssize_t length = read(device->fd, buffer, max_length);
+
+    return (0 < length) ? length : 0;
+}
+
+void device_send_byte(void *usr_ptr, uint8_t byte)
+{
+    device_send_buffer(usr_ptr, &byte, 1);
+}
+
+void device_send_buffer(void *usr_ptr, const uint8_t *buffer, uint16_t length)
+{
+    struct eubxd_device *device = (struct eubxd_device *)usr_ptr;
+    struct iovec iov;
+
+    iov.iov_base = (void *)buffer;
+    iov.iov_len = length;
+    write_device(device, &iov, 1);
+}
+
+void device_send_vector(void *usr_ptr, const struct eubx_tx_segment *segments, uint8_t count)
+{
+    struct eubxd_device *device = (struct eubxd_device *)usr_ptr;
+    struct iovec iov[EUBX_TX_QUEUE_DEPTH];
+
+    for (int i = 0; i < count; i++)
+    {
+        iov[i].iov_base = (void *)segments[i].buffer;
+        iov[i].iov_len = segments[i].length;
+    }
+
+    write_device(device, iov, count);
+}
+
+/*
+ * The descriptor is non blocking, so a write may take only part of the frames. The rest
+ * is written once the output buffer has room again, waiting at most EUBXD_WRITE_TIMEOUT_MS
+ * for it; a receiver that stopped reading loses the frames instead of stalling the worker.
+ */
+bool write_device(struct eubxd_device *device, struct iovec *iov, int count)
+{
+    struct pollfd writable;
+    bool written = true;
+
+    writable.fd = device->fd;
+    writable.events = POLLOUT;
+
+    while (written && (0 < count))
+    {
+        ssize_t length = writev(device->fd, iov, count);
+
+        if (0 <= length)
+        {
+            // segments written completely are dropped, a partial one keeps its rest
+            while ((0 < count) && ((size_t)length >= iov->iov_len))
+            {
+                length -= iov->iov_len;
+                iov++;
+                count--;
+            }
+
+            if (0 < count)
+            {
+                iov->iov_base = (uint8_t *)iov->iov_base + length;
+                iov->iov_len -= length;
+            }
+        }
+        else if ((EAGAIN == errno) || (EWOULDBLOCK == errno))
+        {
+            if (0 == poll(&writable, 1, EUBXD_WRITE_TIMEOUT_MS))
+            {
+                errno = ETIMEDOUT;
+                written = false;
+            }
+        }
+        else if (EINTR != errno)
+        {
+            written = false;
+        }
+    }
+
+    if (!written)
+    {
+        fprintf(stderr, "%s: %s\n", device->path, strerror(errno));
+    }
+
+    return written;
+}
+
+void device_wait_input(void *usr_ptr, uint32_t timeout_us)
+{
+    struct eubxd_device *device = (struct eubxd_device *)usr_ptr;
+    struct pollfd pfd;
+
+    // only used by the init sequence, afterwards epoll reports readiness; poll has no FD_SETSIZE limit
+    pfd.fd = device->fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    poll(&pfd, 1, (timeout_us + 999) / 1000);
+}
+
+void device_notify_event(void *usr_ptr, TEasyUBXEvent event)
+{
+    struct eubxd_device *device = (struct eubxd_device *)usr_ptr;
+    const struct eubx_nav_pvt *pvt = &device->handle.nav_pvt;
+    const struct eubx_mon_ports *ports = &device->handle.mon_ports;
+    const struct eubx_mon_hw *hw = &device->handle.mon_hw;
+
+    device->events++;
+
+    if (device->ready && (EUBXReceivedNavPVT == event))
+    {
+        printf("%s: fix=%u sv=%u lat=%d lon=%d hmsl=%dmm hacc=%umm\n", device->name, pvt->fix_type, pvt->num_sv, pvt->latitude_deg_e7, pvt->longitude_deg_e7, pvt->height_msl_mm, pvt->horizontal_accuracy_mm);
+    }
+    else if (EUBXReceivedMonTXBUF == event)
+    {
+        printf("%s: tx buffer usage=%u%% peak=%u%% errors=%02x\n", device->name, ports->tx_usage_percent, ports->tx_peak_usage_percent, ports->tx_errors);
+    }
+    else if (EUBXBringUpReady == event)
+    {
+        device_ready(device);
+    }
+    else if (EUBXBringUpFailed == event)
+    {
+        fprintf(stderr, "%s: no answer from the receiver\n", device->path);
+    }
+    else if ((EUBXReceivedSecUNIQID == event) && (EUBXWarmNone == device->handle.warm_status))
+    {
+        name_device(device);
+        device->save_state = true;
+    }
+    else if ((EUBXWarmStartVerified == event) || (EUBXWarmStartMismatch == event))
+    {
+        printf("%s: cached receiver state %s\n", device->name, (EUBXWarmStartVerified == event) ? "verified" : "outdated, polling again");
+        device->save_state = true;
+    }
+    else if (EUBXReceivedMonHW == event)
+    {
+        printf("%s: noise=%u agc=%u jamming state=%u indicator=%u\n", device->name, hw->noise_per_ms, hw->agc_count, hw->jamming_state, hw->jamming_indicator);
+    }
+}
+
+uint32_t host_time_us(void *usr_ptr)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint32_t)(now.tv_sec * 1000000ULL + now.tv_nsec / 1000);
+}
+
+void handle_signal(int signal_number)
+{
+    uint64_t value = 1;
+
+    if (SIGUSR1 != signal_number)
+    {
+        // wakes every worker, the eventfd stays readable
+        stopping = 1;
+        (void)write(stop_fd, &value, sizeof(value));
+    }
+
+    (void)write(stats_fd, &value, sizeof(value));
+}
+
+speed_t baud_to_speed(long baud)
+{
+    speed_t speed = 0;
+
+    switch (baud)
+    {
+    case 9600:
+        speed = B9600;
+        break;
+
+    case 19200:
+        speed = B19200;
+        break;
+
+    case 38400:
+        speed = B38400;
+        break;
+
+    case 57600:
+        speed = B57600;
+        break;
+
+    case 115200:
+        speed = B115200;
+        break;
+
+    case 230400:
+        speed = B230400;
+        break;
+
+    case 460800:
+        speed = B460800;
+        break;
+
+    case 921600:
+        speed = B921600;
+        break;
+
+    default:
+        break;
+    }
+
+    return speed;
+}
+
+void usage(const char *program)
+{
+    fprintf(stderr, "usage: %s [-w workers] [-c first cpu] [-b baud] [-m telemetry interval ms] [-s state dir] device...\n", program);
+}
+
+#endif /* __linux__ */
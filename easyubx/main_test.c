@@ -1,23 +1,61 @@
 #include <errno.h>
 #include <fcntl.h> 
+#include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/uio.h>
 #include <termios.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "easyubx_drv.h"
+#include "easyubx_host_capture.h"
+#include "easyubx_host_reader.h"
 
 
 struct eubx_handle ubx;
+uint8_t tx_queue[512];
+struct eubx_host_reader reader;
+uint8_t reader_ring[1 << 16];
+struct eubx_capture_writer capture;
+struct eubx_replay replay;
 
 uint16_t ser_receive_buffer(void *usr_ptr, uint8_t *buffer, uint16_t max_len) 
 {
 	int fd = (int) usr_ptr;
-	uint16_t len = read(fd, buffer, max_len);
-	return len;
+	ssize_t len = read(fd, buffer, max_len);
+	return len > 0 ? len : 0;
 };
 
+void ser_wait_input(void *usr_ptr, uint32_t timeout_us)
+{
+	struct pollfd pfd;
+	pfd.fd = (int) usr_ptr;
+	pfd.events = POLLIN;
+	poll(&pfd, 1, (timeout_us + 999) / 1000);
+}
+
+uint16_t ring_receive_buffer(void *usr_ptr, uint8_t *buffer, uint16_t max_len)
+{
+	return eubx_host_reader_read(&reader, buffer, max_len);
+}
+
+void ring_wait_input(void *usr_ptr, uint32_t timeout_us)
+{
+	eubx_host_reader_wait(&reader, timeout_us);
+}
+
+uint16_t replay_receive_buffer(void *usr_ptr, uint8_t *buffer, uint16_t max_len)
+{
+	return eubx_replay_read(&replay, buffer, max_len);
+}
+
+void replay_wait_input(void *usr_ptr, uint32_t timeout_us)
+{
+	eubx_replay_wait(&replay, timeout_us);
+}
+
 void ser_send_byte(void* user_ptr, uint8_t b) {
 	int fd = (int) user_ptr;
 	write(fd, &b, 1);
@@ -28,6 +66,16 @@ void ser_send_buffer(void* ptr, const uint8_t *buf, uint16_t len) {
 	write(fd, buf, len);
 }
 
+void ser_send_vector(void* ptr, const struct eubx_tx_segment *segments, uint8_t count) {
+	int fd = (int) ptr;
+	struct iovec iov[EUBX_TX_QUEUE_DEPTH];
+	for (int i = 0; i < count; i++) {
+		iov[i].iov_base = (void *) segments[i].buffer;
+		iov[i].iov_len = segments[i].length;
+	}
+	writev(fd, iov, count);
+}
+
 void test_notify_event(void* ptr, TEasyUBXEvent event) {
 	printf("\n--Notify event %d\n", event);
 	printf("len=%d, error=%d, class=%02x, msg_id=%02x\n", ubx.receive_message.message_length, ubx.last_error, ubx.receive_message.message_class, ubx.receive_message.message_id);
@@ -50,16 +98,38 @@ void test_notify_event(void* ptr, TEasyUBXEvent event) {
         case EUBXReceivedNAK:
 		printf("NACK for class=%02x, id=%02x\n", ubx.receive_message.message_buffer[0], ubx.receive_message.message_buffer[1]);
             break;
+
+        case EUBXReceivedNavPVT:
+		printf("NavPVT fix=%d, sv=%d, lat=%d, lon=%d, hmsl=%dmm, hacc=%umm\n", ubx.nav_pvt.fix_type, ubx.nav_pvt.num_sv, ubx.nav_pvt.latitude_deg_e7, ubx.nav_pvt.longitude_deg_e7, ubx.nav_pvt.height_msl_mm, ubx.nav_pvt.horizontal_accuracy_mm);
+		break;
 	default:
-		for (int i=0; i< ubx.receive_message.message_length; i++ ) {
-            printf("%02x ", ubx.receive_message.message_buffer[i]);
-        }
-        printf("\n");
 		break;
         }
     
 };
 
+void test_notify_message(void* ptr, const struct eubx_message_view *view) {
+	printf("\n--Message class=%02x, msg_id=%02x, len=%d, time=%u\n", view->message_class, view->message_id, view->message_length, view->timestamp);
+	for (int i=0; i< view->message_length; i++ ) {
+		printf("%02x ", view->payload[i]);
+	}
+	printf("\n");
+}
+
+void test_notify_nmea(void* ptr, const char *sentence, uint16_t length) {
+	printf("--NMEA %.*s", length, sentence);
+}
+
+void test_notify_rtcm(void* ptr, const uint8_t *frame, uint16_t length) {
+	printf("--RTCM3 type=%d, len=%d\n", (frame[3] << 4) | (frame[4] >> 4), length);
+}
+
+uint32_t host_time_us(void* ptr) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)(ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000);
+}
+
 int set_interface_attribs(int fd, int speed)
 {
     struct termios tty;
@@ -95,6 +165,29 @@ int set_interface_attribs(int fd, int speed)
     return 0;
 }
 
+bool ser_set_baud(void* ptr, uint32_t baud)
+{
+    int fd = (int) ptr;
+    speed_t speed;
+
+    switch (baud) {
+    case 9600: speed = B9600; break;
+    case 19200: speed = B19200; break;
+    case 38400: speed = B38400; break;
+    case 57600: speed = B57600; break;
+    case 115200: speed = B115200; break;
+    case 230400: speed = B230400; break;
+    case 460800: speed = B460800; break;
+    default: return false;
+    }
+
+    tcdrain(fd);
+    if (set_interface_attribs(fd, speed) != 0)
+        return false;
+    tcflush(fd, TCIFLUSH);
+    return true;
+}
+
 void set_mincount(int fd, int mcount)
 {
     struct termios tty;
@@ -233,18 +326,94 @@ int main(int argc, const char** argv)
     char *portname = "/dev/ttyUSB0";
     int fd;
     int wlen;
+    int threaded = 0;
+    const char *capture_path = NULL;
+    const char *replay_path = NULL;
+    int replay_realtime = 0;
+    eubx_receive_buffer receive_buffer = ser_receive_buffer;
+
+    // -t moves reading the tty into its own thread, -c records a capture, -r and -f replay one in real time or as fast as possible
+    while (argc > 1 && argv[1][0] == '-') {
+        if (strcmp(argv[1], "-t") == 0) {
+            threaded = 1;
+        } else if (argc > 2 && strcmp(argv[1], "-c") == 0) {
+            capture_path = argv[2];
+            argc--;
+            argv++;
+        } else if (argc > 2 && (strcmp(argv[1], "-r") == 0 || strcmp(argv[1], "-f") == 0)) {
+            replay_path = argv[2];
+            replay_realtime = argv[1][1] == 'r';
+            argc--;
+            argv++;
+        } else {
+            printf("usage: main_test [-t] [-c capture] [-r|-f capture] [script...]\n");
+            return -1;
+        }
+        argc--;
+        argv++;
+    }
 
-    fd = open(portname, O_RDWR | O_NOCTTY | O_SYNC);
-    if (fd < 0) {
-        printf("Error opening %s: %s\n", portname, strerror(errno));
-        return -1;
+    if (replay_path) {
+        if (eubx_replay_open(&replay, replay_path, replay_realtime) != EUBX_ERROR_OK) {
+            printf("Error opening capture %s\n", replay_path);
+            return -1;
+        }
+        fd = -1;
+        threaded = 0;
+        receive_buffer = replay_receive_buffer;
+    } else {
+        fd = open(portname, O_RDWR | O_NOCTTY | O_SYNC | O_NONBLOCK);
+        if (fd < 0) {
+            printf("Error opening %s: %s\n", portname, strerror(errno));
+            return -1;
+        }
+        /* 8 bits, no parity, 1 stop bit, init searches the baud rate from 9600 on */
+        set_interface_attribs(fd, B9600);
     }
-    /*baudrate 115200, 8 bits, no parity, 1 stop bit */
-    set_interface_attribs(fd, B9600);
     //set_mincount(fd, 0);                /* set to pure timed read */
 	
 
-    TEasyUBXError e0 = eubx_init(&ubx, ser_receive_buffer, ser_send_byte, ser_send_buffer, test_notify_event, (void *) fd);
+    struct eubx_init_options options = {0};
+    options.notify_message = test_notify_message;
+    options.get_time = host_time_us;
+    options.wait_input = ser_wait_input;
+    options.tx_queue = tx_queue;
+    options.tx_queue_size = sizeof(tx_queue);
+    options.send_vector = ser_send_vector;
+    options.notify_nmea = test_notify_nmea;
+    options.notify_rtcm = test_notify_rtcm;
+    options.fast_resync = true;
+
+    if (replay_path) {
+        options.wait_input = replay_wait_input;
+    } else if (!threaded) {
+        options.set_baud = ser_set_baud;
+        options.baud_rate = 9600;
+    }
+
+    if (capture_path) {
+        if (eubx_capture_open(&capture, capture_path) != EUBX_ERROR_OK) {
+            printf("Error creating capture %s\n", capture_path);
+            return -1;
+        }
+        options.tap = eubx_capture_tap;
+        options.tap_usr_ptr = &capture;
+    }
+
+    if (threaded) {
+        if (eubx_host_reader_start(&reader, fd, reader_ring, sizeof(reader_ring)) != EUBX_ERROR_OK) {
+            printf("Error starting reader thread\n");
+            return -1;
+        }
+        receive_buffer = ring_receive_buffer;
+        options.wait_input = ring_wait_input;
+    }
+
+    // the init handshake is answered from the capture too, so timing starts here
+    struct timespec replay_start;
+    clock_gettime(CLOCK_MONOTONIC, &replay_start);
+
+    TEasyUBXError e0 = eubx_init_ex(&ubx, receive_buffer, ser_send_byte, ser_send_buffer, test_notify_event, (void *) fd, &options);
 	if (e0 != EUBX_ERROR_OK) {
 		printf("Error initializing ubx: %d\n", e0);
 		return e0;	
@@ -253,6 +422,29 @@ int main(int argc, const char** argv)
 	printf("ubx inited\n");
 	printf("chipset %x, software %s\n", ubx.receiver_info.chipset_version, ubx.receiver_info.software_version);
 
+    if (options.set_baud) {
+        static const struct eubx_message_rate plan[] = {{0x01, 0x07, {0, 1, 0, 1, 0, 0}}, {0x01, 0x35, {0, 1, 0, 1, 0, 0}}};
+
+        e0 = eubx_upgrade_baud(&ubx, NULL, 0);
+        printf("link at %u baud, upgrade %d, NAV-PVT and NAV-SAT need %u bytes/s, check %d\n", ubx.baud_rate, e0, eubx_message_plan_load(plan, 2, ubx.receiver_config.port.port_id, ubx.receiver_config.measurement_rate, ubx.receiver_config.navigation_rate), eubx_check_message_plan(&ubx, plan, 2));
+
+        if (eubx_check_message_plan(&ubx, plan, 2) == EUBX_ERROR_OK) {
+            e0 = eubx_disable_default_nmea(&ubx);
+            printf("default NMEA off %d, plan %d\n", e0, eubx_apply_message_plan(&ubx, plan, 2));
+        }
+    }
+
+    if (replay_path) {
+        struct timespec end;
+        eubx_replay_run(&replay, &ubx);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double seconds = (end.tv_sec - replay_start.tv_sec) + (end.tv_nsec - replay_start.tv_nsec) / 1e9;
+        uint64_t bytes = replay.rx_bytes;
+        printf("replayed %llu bytes in %.3f s, %.1f MB/s\n", (unsigned long long) bytes, seconds, seconds > 0 ? bytes / seconds / 1e6 : 0);
+        eubx_replay_close(&replay);
+        return 0;
+    }
+
     if (argc > 1) {
         for(int i=1; i<argc; i++) {
             printf("Arg %d: %s\n", i, argv[i]);
@@ -261,9 +453,18 @@ int main(int argc, const char** argv)
     }
 
 	while(1) {
-		eubx_loop(&ubx);
-		sleep(10);	
-		
+		if (threaded) {
+			uint32_t high_water = eubx_spsc_high_water(&reader.ring);
+			eubx_host_reader_wait(&reader, 10000000);
+			eubx_host_reader_drain(&reader, &ubx);
+			eubx_loop(&ubx);
+			if (eubx_spsc_high_water(&reader.ring) > high_water) {
+				printf("ring high water %u of %u\n", eubx_spsc_high_water(&reader.ring), reader.ring.size);
+			}
+		} else {
+			eubx_loop(&ubx);
+			ser_wait_input((void *) fd, 10000000);
+		}
 	}
 	
 }